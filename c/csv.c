@@ -0,0 +1,446 @@
+/*
+ * Main developer: Nico Van Cleemput
+ * In collaboration with: Craig Larson
+ *
+ * Copyright (C) 2013 Ghent University.
+ * Licensed under the GNU GPL, read the file LICENSE.txt for details.
+ */
+
+/* A simple CSV reader for the invariant values.
+ *
+ * The first line of the file contains the column names. Each other non-blank
+ * line contains one row with a value for each column. Fields can be quoted,
+ * but quoted fields can not contain line breaks. Empty fields and fields
+ * containing NA are read as NaN. The values TRUE and FALSE are read as 1 and
+ * 0.
+ *
+ * The file is mapped into memory and the rows are split into chunks that are
+ * read in parallel.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "bintrees.h"
+#include "util.h"
+#include "csv.h"
+
+#define MAX_FIELD_LENGTH 1024
+
+//------------------ Fields --------------------
+
+/* Returns the end of the line starting at line, i.e., the position of the
+ * newline character or end.
+ */
+char *findLineEnd(char *line, char *end){
+    char *lineEnd = memchr(line, '\n', end - line);
+    return lineEnd == NULL ? end : lineEnd;
+}
+
+boolean isBlankLine(char *line, char *lineEnd){
+    while(line < lineEnd){
+        if(!isspace((unsigned char)*line)){
+            return FALSE;
+        }
+        line++;
+    }
+    return TRUE;
+}
+
+/* Copies the field starting at position to field and returns the position
+ * after the field (i.e., the position of the separator or lineEnd). Quotes are
+ * removed and whitespace around the field is trimmed. Returns NULL if the field
+ * is malformed or too long.
+ */
+char *readField(char *position, char *lineEnd, char *field){
+    int length = 0;
+
+    while(position < lineEnd && isspace((unsigned char)*position)){
+        position++;
+    }
+
+    if(position < lineEnd && *position == '"'){
+        position++;
+        while(TRUE){
+            if(position == lineEnd){
+                return NULL; //unterminated quote
+            }
+            if(*position == '"'){
+                if(position + 1 < lineEnd && *(position + 1) == '"'){
+                    position++; //escaped quote
+                } else {
+                    position++;
+                    break;
+                }
+            }
+            if(length == MAX_FIELD_LENGTH - 1){
+                return NULL;
+            }
+            field[length++] = *position;
+            position++;
+        }
+        while(position < lineEnd && *position != ','){
+            if(!isspace((unsigned char)*position)){
+                return NULL; //text after closing quote
+            }
+            position++;
+        }
+    } else {
+        while(position < lineEnd && *position != ','){
+            if(length == MAX_FIELD_LENGTH - 1){
+                return NULL;
+            }
+            field[length++] = *position;
+            position++;
+        }
+        while(length > 0 && isspace((unsigned char)field[length - 1])){
+            length--;
+        }
+    }
+
+    field[length] = '\0';
+    return position;
+}
+
+/* Converts a field to a value. Returns FALSE if the field is not a number.
+ */
+boolean convertField(char *field, double *value){
+    if(field[0] == '\0' || !strcmp(field, "NA")){
+        *value = NAN;
+        return TRUE;
+    }
+    if(!strcmp(field, "TRUE") || !strcmp(field, "True") || !strcmp(field, "true")){
+        *value = 1.0;
+        return TRUE;
+    }
+    if(!strcmp(field, "FALSE") || !strcmp(field, "False") || !strcmp(field, "false")){
+        *value = 0.0;
+        return TRUE;
+    }
+    char *fieldEnd;
+    *value = strtod(field, &fieldEnd);
+    return *fieldEnd == '\0';
+}
+
+//------------------ Threads --------------------
+
+typedef struct csvchunkjob {
+    CSVFILE *csv;
+    int chunk;
+
+    //only used while reading
+    int *columnTargets;
+    double **values;
+
+    //the result
+    int rowCount;
+    int errorRow;
+    int errorColumn;
+} CSVCHUNKJOB;
+
+void *countChunkRows(void *argument){
+    CSVCHUNKJOB *job = (CSVCHUNKJOB *)argument;
+    char *line = job->csv->chunkStart[job->chunk];
+    char *end = job->csv->chunkStart[job->chunk + 1];
+
+    job->rowCount = 0;
+    while(line < end){
+        char *lineEnd = findLineEnd(line, end);
+        if(!isBlankLine(line, lineEnd)){
+            job->rowCount++;
+        }
+        line = lineEnd + 1;
+    }
+    return NULL;
+}
+
+void *readChunkRows(void *argument){
+    CSVCHUNKJOB *job = (CSVCHUNKJOB *)argument;
+    CSVFILE *csv = job->csv;
+    char *line = csv->chunkStart[job->chunk];
+    char *end = csv->chunkStart[job->chunk + 1];
+    int row = csv->chunkFirstRow[job->chunk];
+    char field[MAX_FIELD_LENGTH];
+
+    job->errorRow = -1;
+    while(line < end){
+        char *lineEnd = findLineEnd(line, end);
+        if(isBlankLine(line, lineEnd)){
+            line = lineEnd + 1;
+            continue;
+        }
+
+        char *position = line;
+        int column = 0;
+        while(TRUE){
+            position = readField(position, lineEnd, field);
+            if(position == NULL || column == csv->columnCount){
+                job->errorRow = row;
+                job->errorColumn = column;
+                return NULL;
+            }
+            if(job->columnTargets[column] >= 0){
+                double value;
+                if(!convertField(field, &value)){
+                    job->errorRow = row;
+                    job->errorColumn = column;
+                    return NULL;
+                }
+                job->values[job->columnTargets[column]][row] = value;
+            }
+            column++;
+            if(position == lineEnd){
+                break;
+            }
+            position++; //skip separator
+        }
+        if(column != csv->columnCount){
+            job->errorRow = row;
+            job->errorColumn = column;
+            return NULL;
+        }
+
+        row++;
+        line = lineEnd + 1;
+    }
+    return NULL;
+}
+
+/* Runs the function for each chunk. The first chunk is handled by the calling
+ * thread.
+ */
+void runChunkJobs(CSVFILE *csv, CSVCHUNKJOB *jobs, void *(*function)(void *)){
+    int i;
+    pthread_t threads[csv->chunkCount];
+    boolean threadStarted[csv->chunkCount];
+
+    for(i = 1; i < csv->chunkCount; i++){
+        threadStarted[i] = !pthread_create(threads + i, NULL, function, jobs + i);
+        if(!threadStarted[i]){
+            //just do the work ourselves
+            function(jobs + i);
+        }
+    }
+    function(jobs);
+    for(i = 1; i < csv->chunkCount; i++){
+        if(threadStarted[i]){
+            pthread_join(threads[i], NULL);
+        }
+    }
+}
+
+//------------------ Public functions --------------------
+
+void loadCSVFile(CSVFILE *csv, const char *filename){
+    FILE *f = fopen(filename, "r");
+    if(f == NULL){
+        fprintf(stderr, "Could not open CSV file %s -- exiting!\n", filename);
+        exit(EXIT_FAILURE);
+    }
+
+    struct stat fileStatus;
+    if(fstat(fileno(f), &fileStatus) == 0 && S_ISREG(fileStatus.st_mode) &&
+            fileStatus.st_size > 0){
+        char *mapping = mmap(NULL, fileStatus.st_size, PROT_READ, MAP_PRIVATE,
+                fileno(f), 0);
+        if(mapping != MAP_FAILED){
+            csv->data = mapping;
+            csv->size = fileStatus.st_size;
+            csv->mapped = TRUE;
+            fclose(f);
+            return;
+        }
+    }
+
+    //not a regular file: read the complete file
+    size_t capacity = 1 << 16;
+    size_t count;
+    csv->size = 0;
+    csv->mapped = FALSE;
+    csv->data = (char *)malloc(capacity);
+    if(csv->data == NULL){
+        fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+    while((count = fread(csv->data + csv->size, 1, capacity - csv->size, f)) > 0){
+        csv->size += count;
+        if(csv->size == capacity){
+            capacity *= 2;
+            csv->data = (char *)realloc(csv->data, capacity);
+            if(csv->data == NULL){
+                fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    fclose(f);
+}
+
+/* Opens the CSV file, reads the header and counts the rows. The rows are split
+ * into at most threadCount chunks.
+ */
+void openCSVFile(CSVFILE *csv, const char *filename, int threadCount){
+    int i;
+    char field[MAX_FIELD_LENGTH];
+
+    loadCSVFile(csv, filename);
+    char *end = csv->data + csv->size;
+
+    //read the header
+    char *headerEnd = findLineEnd(csv->data, end);
+    if(headerEnd > csv->data && *(headerEnd - 1) == '\r'){
+        headerEnd--;
+    }
+    if(isBlankLine(csv->data, headerEnd)){
+        BAILOUT("Error while reading CSV file: no header")
+    }
+    csv->columnCount = 1;
+    for(i = 0; csv->data + i < headerEnd; i++){
+        if(csv->data[i] == ','){
+            //this can be too large if there are quoted commas
+            csv->columnCount++;
+        }
+    }
+    csv->columnNames = (char **)malloc(sizeof(char *) * csv->columnCount);
+    if(csv->columnNames == NULL){
+        fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+    char *position = csv->data;
+    int column = 0;
+    while(TRUE){
+        position = readField(position, headerEnd, field);
+        if(position == NULL){
+            BAILOUT("Error while reading CSV file: malformed header")
+        }
+        csv->columnNames[column] = (char *)malloc(strlen(field) + 1);
+        if(csv->columnNames[column] == NULL){
+            fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+            exit(EXIT_FAILURE);
+        }
+        strcpy(csv->columnNames[column], field);
+        column++;
+        if(position == headerEnd){
+            break;
+        }
+        position++; //skip separator
+    }
+    csv->columnCount = column;
+
+    //split the rows into chunks
+    char *firstRow = findLineEnd(csv->data, end);
+    if(firstRow < end){
+        firstRow++;
+    }
+    if(threadCount < 1){
+        threadCount = 1;
+    }
+    csv->chunkCount = threadCount;
+    csv->chunkStart = (char **)malloc(sizeof(char *) * (csv->chunkCount + 1));
+    csv->chunkFirstRow = (int *)malloc(sizeof(int) * csv->chunkCount);
+    if(csv->chunkStart == NULL || csv->chunkFirstRow == NULL){
+        fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+    csv->chunkStart[0] = firstRow;
+    for(i = 1; i < csv->chunkCount; i++){
+        char *start = firstRow + (end - firstRow) / csv->chunkCount * i;
+        if(start < csv->chunkStart[i - 1]){
+            start = csv->chunkStart[i - 1];
+        }
+        //chunks start at the beginning of a line
+        if(start > firstRow && *(start - 1) != '\n'){
+            start = findLineEnd(start, end);
+            if(start < end){
+                start++;
+            }
+        }
+        csv->chunkStart[i] = start;
+    }
+    csv->chunkStart[csv->chunkCount] = end;
+
+    //count the rows
+    CSVCHUNKJOB jobs[csv->chunkCount];
+    for(i = 0; i < csv->chunkCount; i++){
+        jobs[i].csv = csv;
+        jobs[i].chunk = i;
+    }
+    runChunkJobs(csv, jobs, countChunkRows);
+    csv->rowCount = 0;
+    for(i = 0; i < csv->chunkCount; i++){
+        csv->chunkFirstRow[i] = csv->rowCount;
+        csv->rowCount += jobs[i].rowCount;
+    }
+}
+
+/* Returns the index of the column with the given name. If there is no such
+ * column and the given column is a number, then it is interpreted as the
+ * one-based index of the column. Returns -1 if the column does not exist.
+ */
+int findCSVColumn(CSVFILE *csv, const char *column){
+    int i;
+    for(i = 0; i < csv->columnCount; i++){
+        if(!strcmp(csv->columnNames[i], column)){
+            return i;
+        }
+    }
+    char *columnEnd;
+    long number = strtol(column, &columnEnd, 10);
+    if(*column != '\0' && *columnEnd == '\0' && number >= 1 && number <= csv->columnCount){
+        return number - 1;
+    }
+    return -1;
+}
+
+/* Reads the values of the given columns: values[i][j] will contain the value
+ * of column columns[i] in row j.
+ */
+void readCSVColumns(CSVFILE *csv, int *columns, int count, double **values){
+    int i;
+    int columnTargets[csv->columnCount];
+
+    for(i = 0; i < csv->columnCount; i++){
+        columnTargets[i] = -1;
+    }
+    for(i = 0; i < count; i++){
+        columnTargets[columns[i]] = i;
+    }
+
+    CSVCHUNKJOB jobs[csv->chunkCount];
+    for(i = 0; i < csv->chunkCount; i++){
+        jobs[i].csv = csv;
+        jobs[i].chunk = i;
+        jobs[i].columnTargets = columnTargets;
+        jobs[i].values = values;
+    }
+    runChunkJobs(csv, jobs, readChunkRows);
+
+    for(i = 0; i < csv->chunkCount; i++){
+        if(jobs[i].errorRow >= 0){
+            fprintf(stderr, "Error while reading CSV file: row %d, column %d -- exiting!\n",
+                    jobs[i].errorRow + 1, jobs[i].errorColumn + 1);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+void closeCSVFile(CSVFILE *csv){
+    int i;
+    if(csv->mapped){
+        munmap(csv->data, csv->size);
+    } else {
+        free(csv->data);
+    }
+    for(i = 0; i < csv->columnCount; i++){
+        free(csv->columnNames[i]);
+    }
+    free(csv->columnNames);
+    free(csv->chunkStart);
+    free(csv->chunkFirstRow);
+}
@@ -0,0 +1,39 @@
+/*
+ * Main developer: Nico Van Cleemput
+ * In collaboration with: Craig Larson
+ *
+ * Copyright (C) 2013 Ghent University.
+ * Licensed under the GNU GPL, read the file LICENSE.txt for details.
+ */
+
+#ifndef CSV_H
+#define	CSV_H
+
+#include <stddef.h>
+
+typedef struct csvfile {
+    char *data;
+    size_t size;
+    boolean mapped;
+
+    int columnCount;
+    char **columnNames;
+
+    int rowCount;
+
+    /* The rows are split into chunks which can be handled by different
+     * threads. Chunk i starts at chunkStart[i] and ends at chunkStart[i+1].
+     * The first row of chunk i has number chunkFirstRow[i].
+     */
+    int chunkCount;
+    char **chunkStart;
+    int *chunkFirstRow;
+} CSVFILE;
+
+void openCSVFile(CSVFILE *csv, const char *filename, int threadCount);
+int findCSVColumn(CSVFILE *csv, const char *column);
+void readCSVColumns(CSVFILE *csv, int *columns, int count, double **values);
+void closeCSVFile(CSVFILE *csv);
+
+#endif	/* CSV_H */
+
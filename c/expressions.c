@@ -16,11 +16,20 @@
 #include <unistd.h>
 #include <float.h>
 #include <malloc.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <pthread.h>
 
 #include "bintrees.h"
 #include "util.h"
 #include "printing.h"
 #include "printing_pb.h"
+#include "csv.h"
 
 #define INVARIANT_LABEL 0
 #define UNARY_LABEL 1
@@ -115,8 +124,143 @@ boolean **invariantValues_propertyBased;
 double *knownTheory;
 boolean *knownTheory_propertyBased;
 
+/* Only for property based conjectures: the objects are partitioned when they
+ * are read. The objects 0 up to mainPropertyEnd-1 have the main property, the
+ * objects mainPropertyEnd up to definedObjectsEnd-1 do not have the main
+ * property, and for the remaining objects the main property is undefined.
+ * 
+ * Only the objects that do not have the main property (for sufficient
+ * conditions) or that have the main property (for necessary conditions) can
+ * violate a conjecture. The other defined objects are the ones that decide the
+ * significance of a conjecture.
+ */
+int mainPropertyEnd;
+int definedObjectsEnd;
+
+int violatingObjectsStart;
+int violatingObjectsEnd;
+int decidingObjectsStart;
+int decidingObjectsEnd;
+
+int *objectNumbers; //the original (one-based) number of each object
+
 int objectCount = 0;
 
+/* Only when duplicate objects are collapsed: the number of identical objects
+ * each remaining object stands for. The counts of hits and skips are weighted
+ * by these multiplicities, and weightedObjectCount is the original number of
+ * objects.
+ */
+boolean collapseDuplicates = FALSE;
+int *objectMultiplicity = NULL;
+int weightedObjectCount = 0;
+double *collapsedValues = NULL;
+double *collapsedTheory = NULL;
+
+/* Only when duplicate objects are collapsed: the original (one-based) number
+ * of each remaining object, which is used in the messages.
+ */
+int *collapsedObjectNumbers = NULL;
+
+#define OBJECT_WEIGHT(i) (objectMultiplicity == NULL ? 1 : objectMultiplicity[(i)])
+#define OBJECT_NUMBER(i) (collapsedObjectNumbers == NULL ? (i) + 1 : collapsedObjectNumbers[(i)])
+
+/* Only when redundant invariants are pruned: the pruned invariants are never
+ * used in expressions. A pruned invariant is either constant (prunedReference
+ * is -1) or equal to prunedScale * I + prunedOffset for the invariant I with
+ * number prunedReference.
+ */
+boolean pruneRedundantInvariants = FALSE;
+boolean *invariantPruned = NULL;
+int *prunedReference = NULL;
+double *prunedScale = NULL;
+double *prunedOffset = NULL;
+int prunedInvariantCount = 0;
+
+/* The values of the unary operators applied to the invariants, computed once
+ * after the invariants are read: unaryLeafColumns[id*invariantCount + j] is
+ * the column for the unary operator with the given id applied to invariant j,
+ * or NULL if that column is not precomputed (e.g., because that invariant can
+ * not be used). The table is only built if it is smaller than
+ * UNARY_LEAF_TABLE_LIMIT bytes.
+ */
+#define UNARY_LEAF_TABLE_LIMIT (256UL << 20)
+double **unaryLeafColumns = NULL;
+double *unaryLeafValues = NULL;
+
+/* Only when conjecturing with the dalmatian or grinvin heuristic: the
+ * labelings that would leave too many objects undefined to be accepted are
+ * skipped during the generation. leafExceedsSkips[j] tells whether invariant j
+ * alone is undefined for too many objects, and unaryLeafExceedsSkips[id *
+ * invariantCount + j] whether this is the case for unary operator id applied
+ * to invariant j, based on the domain of that operator. While a tree is
+ * labeled, subtreeExceedsSkips[pos] tells this for the subtree rooted at the
+ * node with post-order position pos.
+ */
+typedef struct columndomain {
+    int undefined;
+    int negative;
+    int belowOne;
+    int outsideUnitInterval; //outside of [-1,1]
+} COLUMN_DOMAIN;
+
+boolean skipUndefinedLabelings = FALSE;
+boolean nanAbsorbingOperators = FALSE; //max, min or ^ are used
+boolean *leafExceedsSkips = NULL;
+boolean *unaryLeafExceedsSkips = NULL;
+boolean subtreeExceedsSkips[MAX_NODES_USED];
+unsigned long int skippedLabelingCount = 0;
+
+/* Only when some invariant, or some unary operator applied to an invariant,
+ * is undefined for some object: bitsets with a bit for each object for which
+ * a value is known to be undefined. A NULL pointer is used instead of an empty
+ * bitset. leafUndefinedMasks[j] is the bitset for invariant j and
+ * unaryLeafUndefinedMasks[id * invariantCount + j] the one for unary operator
+ * id applied to invariant j. While a tree is labeled,
+ * subtreeUndefinedMasks[pos] is the bitset for the subtree rooted at the node
+ * with post-order position pos. This is the union of the bitsets of the
+ * arguments for which an undefined value makes the subtree undefined.
+ */
+#define MASK_BIT(mask, i) (((mask)[(i) >> 6] >> ((i) & 63)) & 1)
+
+boolean undefinedMasksUsed = FALSE;
+int maskWordCount;
+int mainSkipCount; //the weight of the objects for which the main invariant is undefined
+uint64_t *mainUndefinedMask = NULL;
+uint64_t **undefinedMasks = NULL;
+int undefinedMaskCount = 0;
+uint64_t **leafUndefinedMasks;
+uint64_t **unaryLeafUndefinedMasks;
+uint64_t *subtreeUndefinedMasks[MAX_NODES_USED];
+uint64_t *subtreeMaskValues = NULL;
+
+/* Only when --cache-mb is used: the values of small subexpressions are kept
+ * across trees and complexity levels (see the section on the value cache).
+ * While a tree is evaluated, cachedSubtrees[pos] is the cache entry of the
+ * subtree rooted at the node with post-order position pos, or NULL if that
+ * subtree has to be evaluated.
+ */
+#define VALUE_CACHE_MAX_NODES 7
+#define VALUE_CACHE_ADMISSION 4
+#define VALUE_CACHE_NONE -1
+
+typedef struct valuecacheentry {
+    int labels[VALUE_CACHE_MAX_NODES][2];
+    int length;
+    uint64_t hash;
+    double *values;
+    int filled; //the values of the objects before this one are known
+    unsigned long int uses;
+    int pos; //the position of the node in the tree that last used it
+    int next; //the next entry in the same bucket or in the free list
+    int older;
+    int newer;
+} VALUE_CACHE_ENTRY;
+
+unsigned long int valueCacheBudget = 0; //in bytes, 0 disables the cache
+VALUE_CACHE_ENTRY *cachedSubtrees[MAX_NODES_USED];
+boolean valueCacheActive = FALSE;
+
 unsigned long int treeCount = 0;
 unsigned long int labeledTreeCount = 0;
 unsigned long int validExpressionsCount = 0;
@@ -125,13 +269,20 @@ int maximum_complexity_reached = -1;
 boolean report_maximum_complexity_reached = FALSE;
 
 unsigned long int timeOut = 0;
-boolean timeOutReached = FALSE;
+volatile sig_atomic_t timeOutReached = FALSE;
 
-boolean userInterrupted = FALSE;
-boolean terminationSignalReceived = FALSE;
+volatile sig_atomic_t userInterrupted = FALSE;
+volatile sig_atomic_t terminationSignalReceived = FALSE;
 
 boolean heuristicStoppedGeneration = FALSE;
 
+/* This flag is set as soon as any of the reasons to stop the generation occurs
+ * (time out, signal or heuristic stop condition). The generation loops only
+ * poll this flag, so it is important that the heuristics call the method
+ * updateHeuristicStopCondition() each time their state changes.
+ */
+volatile sig_atomic_t generationTerminated = FALSE;
+
 boolean onlyUnlabeled = FALSE;
 boolean onlyLabeled = FALSE;
 boolean generateExpressions = FALSE;
@@ -142,6 +293,8 @@ boolean theoryProvided = FALSE;
 
 boolean printValidExpressions = FALSE;
 
+boolean trackValueError = FALSE; //only needed for the grinvin heuristic
+
 #define GRINVIN_NEXT_OPERATOR_COUNT 0
 
 int nextOperatorCountMethod = GRINVIN_NEXT_OPERATOR_COUNT;
@@ -151,6 +304,56 @@ boolean closeOperatorFile = FALSE;
 FILE *invariantsFile = NULL;
 boolean closeInvariantsFile = FALSE;
 
+char *csvFilename = NULL;
+char *csvMainColumn = NULL;
+char *csvTheoryColumn = NULL;
+char *csvIncludedColumns = NULL;
+char *csvExcludedColumns = NULL;
+
+int threadCount = 1;
+
+int selectedMainInvariant = UNDEFINED; //overrides the main invariant in the input
+
+char *targetSpecification = NULL; //the targets for multi-target conjecturing
+
+FILE *streamFile = NULL; //the file to which conjecture events are streamed
+boolean closeStreamFile = FALSE;
+
+FILE *evaluationFile = NULL; //the conjectures that should be evaluated
+
+char *invariantCostSpecification = NULL; //the costs of the invariants as c1,c2,...
+
+/* The order in which the invariants are tried at the leaves of the labeled
+ * trees: by increasing cost if costs are given, otherwise by number.
+ */
+int *invariantOrder = NULL;
+
+/* A deferred invariant value is a NaN with this bit pattern. */
+#define DEFERRED_VALUE_BITS 0x7ff800000000defeULL
+#define DEMAND_BATCH_SIZE 16
+
+FILE *demandRequestsFile = NULL; //the requests for deferred invariant values
+FILE *demandResponsesFile = NULL; //the answers to these requests
+boolean deferredValuesPresent = FALSE;
+unsigned long int demandRequestCount = 0;
+unsigned long int demandedValuesCount = 0;
+
+/* Only when deferred values are requested: the objects in the order in which
+ * they are evaluated, the position of each object in that order, and the
+ * number of expressions rejected by each object.
+ */
+int *objectOrder = NULL;
+int *objectRank = NULL;
+unsigned long int *objectViolations = NULL;
+
+#define MAX_REPORTED_VIOLATIONS 10
+
+#define MAX_SERVER_JOB_ARGUMENTS 128
+
+char *serverSocketPath = NULL;
+char **datasetSpecifications = NULL; //the datasets for the server as name=filename
+int datasetCount = 0;
+
 #define NO_HEURISTIC -1
 #define DALMATIAN_HEURISTIC 0
 #define GRINVIN_HEURISTIC 1
@@ -160,12 +363,18 @@ int selectedHeuristic = NO_HEURISTIC;
 boolean (*heuristicStopConditionReached)() = NULL;
 void (*heuristicInit)() = NULL;
 void (*heuristicPostProcessing)() = NULL;
+void (*heuristicFree)() = NULL;
+
+FILE *conjectureFile = NULL; //the file to which the conjectures are written
+FILE *statisticsFile = NULL; //the file to which the statistics are written
 
 //function declarations
 
+void updateHeuristicStopCondition();
 void outputExpression(TREE *tree, FILE *f);
 void printExpression(TREE *tree, FILE *f);
 boolean handleComparator(double left, double right, int id);
+double cachedSubtreeValue(NODE *node, int object);
 
 void printExpression_propertyBased(TREE *tree, FILE *f);
 boolean handleComparator_propertyBased(boolean left, boolean right, int id);
@@ -178,6 +387,200 @@ boolean isComplete(TREE *tree){
     return tree->unaryCount == targetUnary && tree->binaryCount == targetBinary;
 }
 
+//----------- Candidate values -------------
+
+/* Valid expressions are evaluated directly into a reusable buffer and are
+ * handed to the heuristic as soon as they are found, so a stop condition or a
+ * tighter error bound takes effect for the next expression. The heuristics
+ * test the significance of an expression against contiguous vectors before
+ * anything is stored, so the tree is only copied when the expression is kept.
+ */
+double *candidateValues = NULL;
+boolean *candidateValues_propertyBased = NULL;
+
+/* Only for multi-target conjecturing: the entry at position j is TRUE if the
+ * current expression is valid for target j.
+ */
+int targetCount = 0;
+boolean *candidateTargetValid = NULL;
+
+void allocateCandidateValues(){
+    if(propertyBased){
+        candidateValues_propertyBased = (boolean *)malloc(sizeof(boolean) * objectCount);
+        if(candidateValues_propertyBased == NULL){
+            fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+            exit(EXIT_FAILURE);
+        }
+    } else {
+        candidateValues = (double *)malloc(sizeof(double) * objectCount);
+        if(candidateValues == NULL){
+            fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    
+    if(targetCount > 0){
+        candidateTargetValid = (boolean *)malloc(sizeof(boolean) * targetCount);
+        if(candidateTargetValid == NULL){
+            fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+void freeCandidateValues(){
+    free(candidateValues);
+    free(candidateValues_propertyBased);
+    free(candidateTargetValid);
+    candidateValues = NULL;
+    candidateValues_propertyBased = NULL;
+    candidateTargetValid = NULL;
+}
+
+//----------- Streaming -------------
+
+/* When streaming is enabled, every change to the pool of conjectures kept by
+ * the heuristic is written as soon as it happens, so callers can consume the
+ * conjectures while the generation is still running. Each event is a JSON
+ * object on a separate line:
+ * 
+ *  {"event":"level","complexity":c,"unary":u,"binary":b,"time":t}
+ *      the generation of expressions with u unary and b binary operators
+ *      (i.e., with complexity c) has started
+ *  {"event":"add","slot":s,"main":m,"comparator":o,"expression":[...],
+ *   "complexity":c,"hits":h,"time":t}
+ *      a conjecture was stored in slot s of the pool for main invariant m and
+ *      comparator o. The expression is given in post-order (i.e., in the same
+ *      order as in the stack output).
+ *  {"event":"remove","slot":s,"main":m,"comparator":o,"time":t}
+ *      the conjecture in slot s was removed from that pool
+ *  {"event":"done","reason":r,"time":t}
+ *      the generation has stopped
+ * 
+ * The time is the number of seconds since the start of the generation.
+ */
+struct timespec streamStartTime;
+
+void startStream(){
+    clock_gettime(CLOCK_MONOTONIC, &streamStartTime);
+}
+
+double getStreamTime(){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - streamStartTime.tv_sec) + 
+            (now.tv_nsec - streamStartTime.tv_nsec) / 1e9;
+}
+
+void writeStreamString(const char *string){
+    fputc('"', streamFile);
+    for(; *string; string++){
+        if(*string == '"' || *string == '\\'){
+            fprintf(streamFile, "\\%c", *string);
+        } else if((unsigned char)(*string) < 0x20){
+            fprintf(streamFile, "\\u%04x", *string);
+        } else {
+            fputc(*string, streamFile);
+        }
+    }
+    fputc('"', streamFile);
+}
+
+void writeStreamTarget(int slot){
+    fprintf(streamFile, "\"slot\":%d,\"main\":", slot);
+    if(useInvariantNames){
+        writeStreamString(invariantNames[mainInvariant]);
+    } else {
+        fprintf(streamFile, "\"I%d\"", mainInvariant + 1);
+    }
+    fprintf(streamFile, ",\"comparator\":\"");
+    if(propertyBased){
+        printComparator_propertyBased(inequality, streamFile);
+    } else {
+        printComparator(inequality, streamFile);
+    }
+    fprintf(streamFile, "\"");
+}
+
+void streamLevelEvent(int unary, int binary){
+    if(streamFile == NULL) return;
+    fprintf(streamFile, "{\"event\":\"level\",\"complexity\":%d,\"unary\":%d,\"binary\":%d,\"time\":%.6f}\n",
+            unary + 2*binary, unary, binary, getStreamTime());
+    fflush(streamFile);
+}
+
+void streamAddEvent(int slot, TREE *tree, int hitCount){
+    int i, length;
+    if(streamFile == NULL) return;
+    fprintf(streamFile, "{\"event\":\"add\",");
+    writeStreamTarget(slot);
+    fprintf(streamFile, ",\"expression\":[");
+    
+    NODE *orderedNodes[tree->unaryCount + 2*(tree->binaryCount) + 1];
+    length = 0;
+    getOrderedNodes(tree->root, orderedNodes, &length);
+    for(i=0; i<length; i++){
+        if(i) fputc(',', streamFile);
+        if(orderedNodes[i]->contentLabel[0] == INVARIANT_LABEL && useInvariantNames){
+            writeStreamString(invariantNames[orderedNodes[i]->contentLabel[1]]);
+        } else {
+            //the operators and the default invariant names need no escaping
+            fputc('"', streamFile);
+            if(propertyBased){
+                printSingleNode_propertyBased(orderedNodes[i], streamFile, NULL);
+            } else {
+                printSingleNode(orderedNodes[i], streamFile, NULL);
+            }
+            fputc('"', streamFile);
+        }
+    }
+    
+    fprintf(streamFile, "],\"complexity\":%d,\"hits\":%d,\"time\":%.6f}\n",
+            tree->unaryCount + 2*(tree->binaryCount), hitCount, getStreamTime());
+    fflush(streamFile);
+}
+
+void streamRemoveEvent(int slot){
+    if(streamFile == NULL) return;
+    fprintf(streamFile, "{\"event\":\"remove\",");
+    writeStreamTarget(slot);
+    fprintf(streamFile, ",\"time\":%.6f}\n", getStreamTime());
+    fflush(streamFile);
+}
+
+void streamDoneEvent(const char *reason){
+    if(streamFile == NULL) return;
+    fprintf(streamFile, "{\"event\":\"done\",\"reason\":\"%s\",\"time\":%.6f}\n",
+            reason, getStreamTime());
+    fflush(streamFile);
+}
+
+/* Returns the number of objects for which the expression is equal to the main
+ * invariant.
+ */
+int countHits(double *values){
+    int i;
+    int hitCount = 0;
+    for(i=0; i<objectCount; i++){
+        if(values[i] == invariantValues[mainInvariant][i]){
+            hitCount += OBJECT_WEIGHT(i);
+        }
+    }
+    return hitCount;
+}
+
+int countHits_propertyBased(boolean *values){
+    int i;
+    int hitCount = 0;
+    for(i=0; i<definedObjectsEnd; i++){
+        if(values[i] != UNDEFINED &&
+                !(values[i]) == !(invariantValues_propertyBased[i][mainInvariant])){
+            hitCount++;
+        }
+    }
+    return hitCount;
+}
+
 //----------- Heuristics -------------
 
 //dalmatian heuristic
@@ -189,8 +592,23 @@ boolean **dalmatianCurrentConjectureValues_propertyBased;
 
 int *dalmatianBestConjectureForObject;
 
+/* The value of the best conjecture for each object, i.e., the entry at
+ * position i equals
+ * dalmatianCurrentConjectureValues[dalmatianBestConjectureForObject[i]][i].
+ * Only for invariant based conjectures.
+ */
+double *dalmatianBestValues;
+
 boolean *dalmatianObjectInBoundArea; //only for property based conjectures
 
+/* Only for property based conjectures: the number of conjectures in use that
+ * decide the object, i.e., that are true for the object in case of sufficient
+ * conditions or that are false for the object in case of necessary conditions.
+ */
+int *dalmatianObjectCoverage;
+
+int dalmatianMainPropertyCount; //i.e., the number of object that have the main property
+
 boolean *dalmatianConjectureInUse;
 
 TREE *dalmatianConjectures;
@@ -201,15 +619,44 @@ inline void dalmatianUpdateHitCount(){
     dalmatianHitCount = 0;
     int i;
     for(i=0; i<objectCount; i++){
-        double currentBest = 
-        dalmatianCurrentConjectureValues[dalmatianBestConjectureForObject[i]][i];
-        if(currentBest == invariantValues[i][mainInvariant]){
+        if(dalmatianBestValues[i] == invariantValues[mainInvariant][i]){
             dalmatianHitCount++;
         }
     }
     
 }
 
+/* Returns TRUE if the expression is more significant than the current
+ * conjectures for at least one object. This is the same test as the one done
+ * by dalmatianHeuristic, but it only scans two contiguous vectors and stops at
+ * the first object for which the expression is better, so the expressions
+ * that are rejected cost a single pass without any bookkeeping.
+ */
+boolean dalmatianIsMoreSignificant(double *values){
+    int i;
+    double *mainValues = invariantValues[mainInvariant];
+    if(inequality==0){
+        for(i=0; i<objectCount; i++){
+            if(!isnan(mainValues[i]) && !(dalmatianBestValues[i] <= values[i])) return TRUE;
+        }
+    } else if(inequality==1){
+        for(i=0; i<objectCount; i++){
+            if(!isnan(mainValues[i]) && !(dalmatianBestValues[i] < values[i])) return TRUE;
+        }
+    } else if(inequality==2){
+        for(i=0; i<objectCount; i++){
+            if(!isnan(mainValues[i]) && !(dalmatianBestValues[i] >= values[i])) return TRUE;
+        }
+    } else if(inequality==3){
+        for(i=0; i<objectCount; i++){
+            if(!isnan(mainValues[i]) && !(dalmatianBestValues[i] > values[i])) return TRUE;
+        }
+    } else {
+        BAILOUT("Unknown comparator ID")
+    }
+    return FALSE;
+}
+
 void dalmatianHeuristic(TREE *tree, double *values){
     int i;
     //this heuristic assumes the expression was true for all objects
@@ -220,7 +667,7 @@ void dalmatianHeuristic(TREE *tree, double *values){
         for(i=0; i<objectCount; i++){
             if(!handleComparator(knownTheory[i], values[i], inequality)){
                 if(verbose){
-                    fprintf(stderr, "Conjecture is more significant than known theory for object %d.\n", i+1);
+                    fprintf(stderr, "Conjecture is more significant than known theory for object %d.\n", OBJECT_NUMBER(i));
                     fprintf(stderr, "%11.6lf vs. %11.6lf\n", knownTheory[i], values[i]);
                 }
                 isMoreSignificant = TRUE;
@@ -239,31 +686,38 @@ void dalmatianHeuristic(TREE *tree, double *values){
         }
         memcpy(dalmatianCurrentConjectureValues[0], values, 
                 sizeof(double)*objectCount);
+        memcpy(dalmatianBestValues, values, sizeof(double)*objectCount);
         for(i=0; i<objectCount; i++){
             dalmatianBestConjectureForObject[i] = 0;
         }
         dalmatianConjectureInUse[0] = TRUE;
         copyTree(tree, dalmatianConjectures + 0);
+        streamAddEvent(0, tree, countHits(values));
         dalmatianFirst = FALSE;
         dalmatianUpdateHitCount();
+        updateHeuristicStopCondition();
         return;
     }
     
     //check the significance
     //----------------------
     
+    if(!dalmatianIsMoreSignificant(values)) return;
+    
     //find the objects for which this bound is better
     isMoreSignificant = FALSE; //the conjecture is not necessarily more significant than the other conjectures
     int conjectureFrequency[objectCount];
     memset(conjectureFrequency, 0, objectCount*sizeof(int));
     for(i=0; i<objectCount; i++){
-        double currentBest = 
-        dalmatianCurrentConjectureValues[dalmatianBestConjectureForObject[i]][i];
+        if(isnan(invariantValues[mainInvariant][i])){
+            continue; //the expression is not evaluated for this object
+        }
+        double currentBest = dalmatianBestValues[i];
         if(handleComparator(currentBest, values[i], inequality)){
             conjectureFrequency[dalmatianBestConjectureForObject[i]]++;
         } else {
             if(verbose){
-                fprintf(stderr, "Conjecture is more significant for object %d.\n", i+1);
+                fprintf(stderr, "Conjecture is more significant for object %d.\n", OBJECT_NUMBER(i));
                 fprintf(stderr, "%11.6lf vs. %11.6lf\n", currentBest, values[i]);
             }
             dalmatianBestConjectureForObject[i] = objectCount;
@@ -291,8 +745,14 @@ void dalmatianHeuristic(TREE *tree, double *values){
         BAILOUT("Error when handling dalmatian heuristic")
     }
     
+    if(dalmatianConjectureInUse[smallestAvailablePosition]){
+        streamRemoveEvent(smallestAvailablePosition);
+    }
     for(i=smallestAvailablePosition+1; i<objectCount; i++){
         if(conjectureFrequency[i]==0){
+            if(dalmatianConjectureInUse[i]){
+                streamRemoveEvent(i);
+            }
             dalmatianConjectureInUse[i] = FALSE;
         }
     }
@@ -302,12 +762,15 @@ void dalmatianHeuristic(TREE *tree, double *values){
     for(i=0; i<objectCount; i++){
         if(dalmatianBestConjectureForObject[i] == objectCount){
             dalmatianBestConjectureForObject[i] = smallestAvailablePosition;
+            dalmatianBestValues[i] = values[i];
         }
     }
     copyTree(tree, dalmatianConjectures + smallestAvailablePosition);
     dalmatianConjectureInUse[smallestAvailablePosition] = TRUE;
+    streamAddEvent(smallestAvailablePosition, tree, countHits(values));
     
     dalmatianUpdateHitCount();
+    updateHeuristicStopCondition();
     
 }
 
@@ -365,6 +828,12 @@ void dalmatianHeuristicInit(){
     for(i = 0; i <= objectCount; i++)
         dalmatianCurrentConjectureValues[i] = (*dalmatianCurrentConjectureValues + objectCount * i);
     
+    dalmatianBestValues = (double *)malloc(sizeof(double) * objectCount);
+    if(dalmatianBestValues == NULL){
+        fprintf(stderr, "Initialisation of Dalmatian heuristic failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+    
     dalmatianHeuristicInit_shared_post();
 }
 
@@ -381,6 +850,17 @@ void dalmatianHeuristicInit_propertyBased(){
         dalmatianObjectInBoundArea[i] = FALSE;
     }
     
+    dalmatianObjectCoverage = (int *)malloc(sizeof(int) * objectCount);
+    if(dalmatianObjectCoverage == NULL){
+        fprintf(stderr, "Initialisation of Dalmatian heuristic failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+    for(i = 0; i < objectCount; i++){
+        dalmatianObjectCoverage[i] = 0;
+    }
+    
+    dalmatianMainPropertyCount = mainPropertyEnd;
+    
     dalmatianCurrentConjectureValues_propertyBased  = (boolean **)malloc(sizeof(double *) * (objectCount + 1));
     if(dalmatianCurrentConjectureValues_propertyBased == NULL){
         fprintf(stderr, "Initialisation of Dalmatian heuristic failed: insufficient memory -- exiting!\n");
@@ -403,19 +883,140 @@ void dalmatianHeuristicPostProcessing(){
     int i;
     for(i=0;i<=objectCount;i++){
         if(dalmatianConjectureInUse[i]){
-            outputExpression(dalmatianConjectures+i, stdout);
+            outputExpression(dalmatianConjectures+i, conjectureFile);
         }
         freeTree(dalmatianConjectures+i);
     }
 }
 
+void dalmatianHeuristicFree_shared(){
+    free(dalmatianBestConjectureForObject);
+    free(dalmatianConjectureInUse);
+    free(dalmatianConjectures);
+}
+
+void dalmatianHeuristicFree(){
+    dalmatianHeuristicFree_shared();
+    free(dalmatianCurrentConjectureValues[0]);
+    free(dalmatianCurrentConjectureValues);
+    free(dalmatianBestValues);
+}
+
+//multi-target dalmatian heuristic
+
+/* When several targets (i.e., a main invariant and a comparator) are given,
+ * each expression is generated and evaluated only once and is then tested
+ * against each target. Each target has its own state of the dalmatian
+ * heuristic. This state is swapped into the global variables of the dalmatian
+ * heuristic when the target is handled, so the heuristic itself is shared.
+ */
+typedef struct dalmatiantarget {
+    int mainInvariant;
+    int inequality;
+    
+    boolean first;
+    double **currentConjectureValues;
+    int *bestConjectureForObject;
+    double *bestValues;
+    boolean *conjectureInUse;
+    TREE *conjectures;
+    int hitCount;
+    
+    boolean stopped;
+} DALMATIAN_TARGET;
+
+DALMATIAN_TARGET *dalmatianTargets;
+
+/* TRUE if not all targets have the same main invariant. In that case the main
+ * invariants are not excluded during the generation, but the expressions that
+ * contain the main invariant of a target are rejected for that target.
+ */
+boolean multipleMainInvariants = FALSE;
+
+void storeDalmatianTarget(DALMATIAN_TARGET *target){
+    target->first = dalmatianFirst;
+    target->currentConjectureValues = dalmatianCurrentConjectureValues;
+    target->bestConjectureForObject = dalmatianBestConjectureForObject;
+    target->bestValues = dalmatianBestValues;
+    target->conjectureInUse = dalmatianConjectureInUse;
+    target->conjectures = dalmatianConjectures;
+    target->hitCount = dalmatianHitCount;
+}
+
+void restoreDalmatianTarget(DALMATIAN_TARGET *target){
+    mainInvariant = target->mainInvariant;
+    inequality = target->inequality;
+    dalmatianFirst = target->first;
+    dalmatianCurrentConjectureValues = target->currentConjectureValues;
+    dalmatianBestConjectureForObject = target->bestConjectureForObject;
+    dalmatianBestValues = target->bestValues;
+    dalmatianConjectureInUse = target->conjectureInUse;
+    dalmatianConjectures = target->conjectures;
+    dalmatianHitCount = target->hitCount;
+}
+
+boolean dalmatianMultiTargetHeuristicStopConditionReached(){
+    int i;
+    for(i = 0; i < targetCount; i++){
+        if(!dalmatianTargets[i].stopped){
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+void dalmatianMultiTargetHeuristic(TREE *tree, double *values, boolean *targetValid){
+    int j;
+    for(j = 0; j < targetCount; j++){
+        DALMATIAN_TARGET *target = dalmatianTargets + j;
+        if(target->stopped || !targetValid[j]) continue;
+        restoreDalmatianTarget(target);
+        dalmatianHeuristic(tree, values);
+        if(dalmatianHeuristicStopConditionReached()){
+            target->stopped = TRUE;
+        }
+        storeDalmatianTarget(target);
+    }
+    restoreDalmatianTarget(dalmatianTargets);
+    updateHeuristicStopCondition();
+}
+
+void dalmatianMultiTargetHeuristicInit(){
+    int i;
+    for(i = 0; i < targetCount; i++){
+        dalmatianFirst = TRUE;
+        dalmatianHitCount = 0;
+        dalmatianHeuristicInit();
+        storeDalmatianTarget(dalmatianTargets + i);
+        dalmatianTargets[i].stopped = FALSE;
+    }
+    restoreDalmatianTarget(dalmatianTargets);
+}
+
+void dalmatianMultiTargetHeuristicPostProcessing(){
+    int i;
+    for(i = 0; i < targetCount; i++){
+        restoreDalmatianTarget(dalmatianTargets + i);
+        dalmatianHeuristicPostProcessing();
+    }
+    restoreDalmatianTarget(dalmatianTargets);
+}
+
+void dalmatianMultiTargetHeuristicFree(){
+    int i;
+    for(i = 0; i < targetCount; i++){
+        restoreDalmatianTarget(dalmatianTargets + i);
+        dalmatianHeuristicFree();
+    }
+    free(dalmatianTargets);
+    targetCount = 0;
+    multipleMainInvariants = FALSE;
+}
+
 inline void dalmatianUpdateHitCount_propertyBased(){
     dalmatianHitCount = 0;
     int i;
-    for(i=0; i<objectCount; i++){
-        if(invariantValues_propertyBased[i][mainInvariant] == UNDEFINED){
-            continue;
-        }
+    for(i=0; i<definedObjectsEnd; i++){
         if(dalmatianObjectInBoundArea[i]){
             dalmatianHitCount++;
         }
@@ -423,6 +1024,25 @@ inline void dalmatianUpdateHitCount_propertyBased(){
     
 }
 
+void dalmatianUpdateCoverage_propertyBased(boolean *values, int delta){
+    int i;
+    if(inequality == SUFFICIENT){
+        for(i = decidingObjectsStart; i < decidingObjectsEnd; i++){
+            if(values[i] != UNDEFINED && values[i]){
+                dalmatianObjectCoverage[i] += delta;
+            }
+        }
+    } else if(inequality == NECESSARY){
+        for(i = decidingObjectsStart; i < decidingObjectsEnd; i++){
+            if(values[i] != UNDEFINED && !(values[i])){
+                dalmatianObjectCoverage[i] += delta;
+            }
+        }
+    } else {
+        BAILOUT("Error when handling dalmatian heuristic: unknown inequality")
+    }
+}
+
 void dalmatianHeuristic_propertyBased(TREE *tree, boolean *values){
     int i;
     //this heuristic assumes the expression was true for all objects
@@ -430,29 +1050,14 @@ void dalmatianHeuristic_propertyBased(TREE *tree, boolean *values){
     //if known theory is provided, we check that first
     boolean isMoreSignificant = FALSE;
     if(theoryProvided){
-        for(i=0; i<objectCount; i++){
-            if(inequality == SUFFICIENT){
-                if(invariantValues_propertyBased[i][mainInvariant] == UNDEFINED ||
-                        !(invariantValues_propertyBased[i][mainInvariant])){
-                    //we're only looking at object that have the main property to decide
-                    //the significance.
-                    continue;
-                }
-            } else if(inequality == NECESSARY){
-                if(invariantValues_propertyBased[i][mainInvariant] == UNDEFINED ||
-                        (invariantValues_propertyBased[i][mainInvariant])){
-                    //we're only looking at object that do not have the main property
-                    //to decide the significance.
-                    continue;
-                }
-            } else {
-                BAILOUT("Error when handling dalmatian heuristic: unknown inequality")
-            }
-            
+        //we're only looking at the objects that have (for sufficient conditions)
+        //or do not have (for necessary conditions) the main property to decide
+        //the significance.
+        for(i=decidingObjectsStart; i<decidingObjectsEnd; i++){
             if(!handleComparator_propertyBased(knownTheory_propertyBased[i],
                 values[i], inequality)){
                 if(verbose){
-                    fprintf(stderr, "Conjecture is more significant than known theory for object %d.\n", i+1);
+                    fprintf(stderr, "Conjecture is more significant than known theory for object %d.\n", objectNumbers[i]);
                 }
                 isMoreSignificant = TRUE;
             }
@@ -469,8 +1074,8 @@ void dalmatianHeuristic_propertyBased(TREE *tree, boolean *values){
             printExpression_propertyBased(tree, stderr);
         }
         memcpy(dalmatianCurrentConjectureValues_propertyBased[0], values, 
-                sizeof(double)*objectCount);
-        for(i=0; i<objectCount; i++){
+                sizeof(boolean)*objectCount);
+        for(i=0; i<definedObjectsEnd; i++){
             if(values[i] == UNDEFINED){
                 continue;
         }
@@ -478,10 +1083,13 @@ void dalmatianHeuristic_propertyBased(TREE *tree, boolean *values){
                 dalmatianObjectInBoundArea[i] = TRUE;
             }
         }
+        dalmatianUpdateCoverage_propertyBased(values, 1);
         dalmatianConjectureInUse[0] = TRUE;
         copyTree(tree, dalmatianConjectures + 0);
+        streamAddEvent(0, tree, countHits_propertyBased(values));
         dalmatianFirst = FALSE;
         dalmatianUpdateHitCount_propertyBased();
+        updateHeuristicStopCondition();
         return;
     }
     
@@ -490,29 +1098,14 @@ void dalmatianHeuristic_propertyBased(TREE *tree, boolean *values){
     
     //find the objects for which this bound is better
     isMoreSignificant = FALSE; //the conjecture is not necessarily more significant than the other conjectures
-    for(i=0; i<objectCount; i++){
-        if(inequality == SUFFICIENT){
-            if(invariantValues_propertyBased[i][mainInvariant] == UNDEFINED ||
-                    !(invariantValues_propertyBased[i][mainInvariant])){
-                //we're only looking at object that have the main property to decide
-                //the significance.
-                continue;
-            }
-        } else if(inequality == NECESSARY){
-            if(invariantValues_propertyBased[i][mainInvariant] == UNDEFINED ||
-                    (invariantValues_propertyBased[i][mainInvariant])){
-                //we're only looking at object that do not have the main property
-                //to decide the significance.
-                continue;
-            }
-        } else {
-            BAILOUT("Error when handling dalmatian heuristic: unknown inequality")
-        }
-        
+    //we're only looking at the objects that have (for sufficient conditions)
+    //or do not have (for necessary conditions) the main property to decide
+    //the significance.
+    for(i=decidingObjectsStart; i<decidingObjectsEnd; i++){
         if(!handleComparator_propertyBased(dalmatianObjectInBoundArea[i],
                 values[i], inequality)){
             if(verbose){
-                fprintf(stderr, "Conjecture is more significant for object %d.\n", i+1);
+                fprintf(stderr, "Conjecture is more significant for object %d.\n", objectNumbers[i]);
             }
             isMoreSignificant = TRUE;
         }
@@ -542,10 +1135,12 @@ void dalmatianHeuristic_propertyBased(TREE *tree, boolean *values){
             values, sizeof(boolean)*objectCount);    
     copyTree(tree, dalmatianConjectures + smallestAvailablePosition);
     dalmatianConjectureInUse[smallestAvailablePosition] = TRUE;
+    streamAddEvent(smallestAvailablePosition, tree, countHits_propertyBased(values));
+    dalmatianUpdateCoverage_propertyBased(values, 1);
     
     //update bounded area
     if(inequality == SUFFICIENT){
-        for(i = 0; i < objectCount; i++){
+        for(i = 0; i < definedObjectsEnd; i++){
             if(values[i] == UNDEFINED){
                 continue;
             }
@@ -553,7 +1148,7 @@ void dalmatianHeuristic_propertyBased(TREE *tree, boolean *values){
                     dalmatianObjectInBoundArea[i] || values[i];
         }
     } else if(inequality == NECESSARY){
-        for(i = 0; i < objectCount; i++){
+        for(i = 0; i < definedObjectsEnd; i++){
             if(values[i] == UNDEFINED){
                 continue;
             }
@@ -565,6 +1160,7 @@ void dalmatianHeuristic_propertyBased(TREE *tree, boolean *values){
     }
     
     dalmatianUpdateHitCount_propertyBased();
+    updateHeuristicStopCondition();
     
     //prune conjectures
     /* We just loop through the conjectures and remove the ones that are no longer
@@ -573,181 +1169,175 @@ void dalmatianHeuristic_propertyBased(TREE *tree, boolean *values){
      * 
      * By definition, this pruning will not influence the bounding area (and the
      * hit count).
+     * 
+     * A conjecture is still significant if it is the only conjecture in use that
+     * decides some object, i.e., if that object has coverage 1 and the conjecture
+     * decides it. The coverage is updated as soon as a conjecture is removed, so
+     * the conjectures that come later see the same state as before.
      */
-    int j, k;
+    int j;
     
-    if(inequality == SUFFICIENT){
-        for(i = 0; i <= objectCount; i++){
-            if(dalmatianConjectureInUse[i]){
-                isMoreSignificant = FALSE;
-                for(j = 0; j < objectCount; j++){
-                    if(invariantValues_propertyBased[j][mainInvariant] == UNDEFINED ||
-                            !(invariantValues_propertyBased[j][mainInvariant])){
-                        //we're only looking at object that have the main property to decide
-                        //the significance.
-                        continue;
-                    }
-                    
-                    //first we check whether the object is in the bound area
-                    boolean localObjectInBoundArea = FALSE;
-                    
-                    for(k = 0; k <= objectCount; k++){
-                        if(dalmatianConjectureInUse[k] && k!=i){
-                            if(dalmatianCurrentConjectureValues_propertyBased[k][j] ==
-                                    UNDEFINED){
-                                continue;
-                            }
-                            localObjectInBoundArea =
-                                    localObjectInBoundArea ||
-                                    dalmatianCurrentConjectureValues_propertyBased[k][j];
-                        }
-                    }
-                    
-                    //then we check whether this conjecture is still significant
-                    if(!handleComparator_propertyBased(localObjectInBoundArea,
-                            dalmatianCurrentConjectureValues_propertyBased[i][j],
-                            inequality)){
-                        if(verbose){
-                            fprintf(stderr, "Conjecture %d is more significant for object %d.\n", i+1, j+1);
-                        }
-                        isMoreSignificant = TRUE;
-                        break;
+    //the value of a conjecture for an object when that conjecture decides
+    //that object
+    boolean decidingValue = (inequality == SUFFICIENT);
+    
+    for(i = 0; i <= objectCount; i++){
+        if(dalmatianConjectureInUse[i]){
+            boolean *conjectureValues = dalmatianCurrentConjectureValues_propertyBased[i];
+            isMoreSignificant = FALSE;
+            for(j = decidingObjectsStart; j < decidingObjectsEnd; j++){
+                if(dalmatianObjectCoverage[j] == 1 &&
+                        conjectureValues[j] != UNDEFINED &&
+                        !(conjectureValues[j]) == !decidingValue){
+                    if(verbose){
+                        fprintf(stderr, "Conjecture %d is more significant for object %d.\n", i+1, objectNumbers[j]);
                     }
+                    isMoreSignificant = TRUE;
+                    break;
                 }
-                //we only keep the conjecture if it is still more significant
-                //for at least one object.
-                dalmatianConjectureInUse[i] = isMoreSignificant;
             }
-        }
-    } else if(inequality == NECESSARY){
-        for(i = 0; i <= objectCount; i++){
-            if(dalmatianConjectureInUse[i]){
-                isMoreSignificant = FALSE;
-                for(j = 0; j < objectCount; j++){
-                    if(invariantValues_propertyBased[j][mainInvariant] == UNDEFINED ||
-                            (invariantValues_propertyBased[j][mainInvariant])){
-                        //we're only looking at object that do not have the main property to decide
-                        //the significance.
-                        continue;
-                    }
-                    
-                    //first we check whether the object is in the bound area
-                    boolean localObjectInBoundArea = TRUE;
-                    
-                    for(k = 0; k <= objectCount; k++){
-                        if(dalmatianConjectureInUse[k] && k!=i){
-                            if(dalmatianCurrentConjectureValues_propertyBased[k][j] ==
-                                    UNDEFINED){
-                                continue;
-                            }
-                            localObjectInBoundArea =
-                                    localObjectInBoundArea &&
-                                    dalmatianCurrentConjectureValues_propertyBased[k][j];
-                        }
-                    }
-                    
-                    //then we check whether this conjecture is still significant
-                    if(!handleComparator_propertyBased(localObjectInBoundArea,
-                            dalmatianCurrentConjectureValues_propertyBased[i][j],
-                            inequality)){
-                        if(verbose){
-                            fprintf(stderr, "Conjecture %d is more significant for object %d.\n", i+1, j+1);
-                        }
-                        isMoreSignificant = TRUE;
-                        break;
-                    }
-                }
-                //we only keep the conjecture if it is still more significant
-                //for at least one object.
-                dalmatianConjectureInUse[i] = isMoreSignificant;
+            //we only keep the conjecture if it is still more significant
+            //for at least one object.
+            if(!isMoreSignificant){
+                dalmatianConjectureInUse[i] = FALSE;
+                streamRemoveEvent(i);
+                dalmatianUpdateCoverage_propertyBased(conjectureValues, -1);
             }
         }
-    } else {
-        BAILOUT("Error when handling dalmatian heuristic: unknown inequality")
     }
 }
     
 boolean dalmatianHeuristicStopConditionReached_propertyBased(){
-    int pCount = 0; //i.e., the number of object that have the main property
-    int i;
-    
-    for(i = 0; i < objectCount; i++){
-        if(invariantValues_propertyBased[i][mainInvariant] == UNDEFINED){
-            continue;
-}
-        if(invariantValues_propertyBased[i][mainInvariant]){
-            pCount++;
-        }
-    }
-
     /* If we specified sufficient conditions, then the variable dalmatianHitCount
      * contains the number of objects in the intersection of all conditions.
      * If we specified necessary conditions, then the variable dalmatianHitCount
      * contains the number of objects in the union of all conditions.
      */
-    return dalmatianHitCount == pCount;
+    return dalmatianHitCount == dalmatianMainPropertyCount;
 }
 
 void (* const dalmatianHeuristicPostProcessing_propertyBased)(void) = 
         dalmatianHeuristicPostProcessing;
 
-//grinvin heuristic
+void dalmatianHeuristicFree_propertyBased(){
+    dalmatianHeuristicFree_shared();
+    free(dalmatianObjectInBoundArea);
+    free(dalmatianObjectCoverage);
+    free(dalmatianCurrentConjectureValues_propertyBased[0]);
+    free(dalmatianCurrentConjectureValues_propertyBased);
+}
+
+//grinvin heuristic
+
+int grinvinExpressionCount = 1; //the number of expressions that are kept
 
 double grinvinBestError = DBL_MAX;
-TREE grinvinBestExpression;
 
-double grinvinValueError(double *values){
-    double result = 0.0;
-    int i;
-    
-    for(i=0; i<objectCount; i++){
-        double diff = values[i] - invariantValues[mainInvariant][i];
-        result += (diff*diff);
-    }
-    return result;
-}
+/* The expressions with the smallest value error found so far, sorted by
+ * increasing value error.
+ */
+TREE *grinvinBestExpressions;
+double *grinvinBestErrors;
+int grinvinStoredExpressions = 0;
+
+/* Any expression with a value error that is at least this bound can no longer
+ * be stored. This bound is used to stop the evaluation of an expression early.
+ */
+double grinvinErrorBound = DBL_MAX;
 
-void grinvinHeuristic(TREE *tree, double *values){
+void grinvinHeuristic(TREE *tree, double *values, double valueError){
+    int i, position;
     //this heuristic assumes the expression was true for all objects
-    double valueError = grinvinValueError(values);
-    if(valueError < grinvinBestError){
+    if(isnan(valueError)) return;
+    
+    position = grinvinStoredExpressions;
+    while(position > 0 && grinvinBestErrors[position - 1] > valueError){
+        position--;
+    }
+    if(position == grinvinExpressionCount) return;
+    
+    //the last stored expression drops out if the list is full
+    int lastPosition = grinvinStoredExpressions < grinvinExpressionCount ?
+        grinvinStoredExpressions : grinvinExpressionCount - 1;
+    TREE spare = grinvinBestExpressions[lastPosition];
+    for(i = lastPosition; i > position; i--){
+        grinvinBestExpressions[i] = grinvinBestExpressions[i - 1];
+        grinvinBestErrors[i] = grinvinBestErrors[i - 1];
+    }
+    grinvinBestExpressions[position] = spare;
+    grinvinBestErrors[position] = valueError;
+    copyTree(tree, grinvinBestExpressions + position);
+    
+    if(grinvinStoredExpressions < grinvinExpressionCount){
+        grinvinStoredExpressions++;
+    }
+    if(grinvinStoredExpressions == grinvinExpressionCount){
+        grinvinErrorBound = grinvinBestErrors[grinvinExpressionCount - 1];
+    }
+    
+    if(position == 0){
         grinvinBestError = valueError;
-        copyTree(tree, &grinvinBestExpression);
+        updateHeuristicStopCondition();
     }
 }
 
 boolean grinvinHeuristicStopConditionReached(){
-    return (1 << (2*targetBinary + targetUnary)) * objectCount >= grinvinBestError;
+    return (1 << (2*targetBinary + targetUnary)) * weightedObjectCount >= grinvinBestError;
 }
 
 void grinvinHeuristicInit(){
-    initTree(&grinvinBestExpression);
+    int i;
+    
+    grinvinBestExpressions = (TREE *)malloc(sizeof(TREE) * grinvinExpressionCount);
+    if(grinvinBestExpressions == NULL){
+        fprintf(stderr, "Initialisation of Grinvin heuristic failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+    grinvinBestErrors = (double *)malloc(sizeof(double) * grinvinExpressionCount);
+    if(grinvinBestErrors == NULL){
+        fprintf(stderr, "Initialisation of Grinvin heuristic failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    for(i = 0; i < grinvinExpressionCount; i++){
+        initTree(grinvinBestExpressions + i);
+    }
 }
 
 void grinvinHeuristicPostProcessing(){
-    outputExpression(&grinvinBestExpression, stdout);
-    freeTree(&grinvinBestExpression);
+    int i;
+    for(i = 0; i < grinvinExpressionCount; i++){
+        if(i < grinvinStoredExpressions){
+            outputExpression(grinvinBestExpressions + i, conjectureFile);
+        }
+        freeTree(grinvinBestExpressions + i);
+    }
+}
+
+void grinvinHeuristicFree(){
+    free(grinvinBestExpressions);
+    free(grinvinBestErrors);
 }
 
 //------ Stop generation -------
 
-boolean shouldGenerationProcessBeTerminated(){
+void updateHeuristicStopCondition(){
     if(heuristicStopConditionReached!=NULL){
         if(heuristicStopConditionReached()){
             heuristicStoppedGeneration = TRUE;
-            return TRUE;
+            generationTerminated = TRUE;
         }
     }
-    if(timeOutReached || userInterrupted || terminationSignalReceived){
-        return TRUE;
-    }
-    
-    return FALSE;
+}
+
+boolean shouldGenerationProcessBeTerminated(){
+    return generationTerminated;
 }
 
 void handleAlarmSignal(int sig){
     if(sig==SIGALRM){
         timeOutReached = TRUE;
+        generationTerminated = TRUE;
     } else {
         fprintf(stderr, "Handler called with wrong signal -- ignoring!\n");
     }
@@ -756,6 +1346,7 @@ void handleAlarmSignal(int sig){
 void handleInterruptSignal(int sig){
     if(sig==SIGINT){
         userInterrupted = TRUE;
+        generationTerminated = TRUE;
     } else {
         fprintf(stderr, "Handler called with wrong signal -- ignoring!\n");
     }
@@ -764,11 +1355,125 @@ void handleInterruptSignal(int sig){
 void handleTerminationSignal(int sig){
     if(sig==SIGTERM){
         terminationSignalReceived = TRUE;
+        generationTerminated = TRUE;
     } else {
         fprintf(stderr, "Handler called with wrong signal -- ignoring!\n");
     }
 }
 
+//------ Deferred invariant values -------
+
+/* The caller can defer the computation of expensive invariant values by
+ * giving them as DEFERRED_VALUE_BITS in a binary invariants file. When the
+ * option --demand-pipes is used, such a value is requested as soon as an
+ * expression needs it. A request is a line containing the (zero-based) number
+ * of the invariant, the number of requested values and the (zero-based)
+ * numbers of the objects. The caller answers it by writing the requested
+ * values as doubles in native byte order. Together with the value that is
+ * needed, the values of that invariant for the next objects in the evaluation
+ * order which are still deferred are requested, up to DEMAND_BATCH_SIZE
+ * values per request.
+ * 
+ * The objects are evaluated in the order of decreasing number of expressions
+ * they rejected, so that expensive values are first requested for the
+ * objects which are most likely to reject an expression.
+ */
+
+boolean isDeferredValue(double value){
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits == DEFERRED_VALUE_BITS;
+}
+
+double requestDeferredValue(int invariant, int object){
+    int i, count = 0;
+    int objects[DEMAND_BATCH_SIZE];
+    double values[DEMAND_BATCH_SIZE];
+    double *column = invariantValues[invariant];
+    for(i = objectRank[object]; i < objectCount && count < DEMAND_BATCH_SIZE; i++){
+        if(isDeferredValue(column[objectOrder[i]])){
+            objects[count++] = objectOrder[i];
+        }
+    }
+    fprintf(demandRequestsFile, "%d %d", invariant, count);
+    for(i = 0; i < count; i++){
+        fprintf(demandRequestsFile, " %d", objects[i]);
+    }
+    fprintf(demandRequestsFile, "\n");
+    fflush(demandRequestsFile);
+    if(fread(values, sizeof(double), count, demandResponsesFile) != count){
+        BAILOUT("Error while reading requested invariant values")
+    }
+    for(i = 0; i < count; i++){
+        //a value that is deferred again would be requested again
+        column[objects[i]] = isDeferredValue(values[i]) ? NAN : values[i];
+    }
+    demandRequestCount++;
+    demandedValuesCount += count;
+    return column[object];
+}
+
+int compareObjectViolations(const void *a, const void *b){
+    int first = *(const int *)a;
+    int second = *(const int *)b;
+    if(objectViolations[first] != objectViolations[second]){
+        return objectViolations[first] > objectViolations[second] ? -1 : 1;
+    }
+    return first - second;
+}
+
+void updateObjectOrder(){
+    int i;
+    qsort(objectOrder, objectCount, sizeof(int), compareObjectViolations);
+    for(i = 0; i < objectCount; i++){
+        objectRank[objectOrder[i]] = i;
+    }
+}
+
+/* Checks the deferred values after the invariants have been read. The main
+ * invariant and the known theory are needed for every expression, so they
+ * cannot be deferred. Returns FALSE if this is the case.
+ */
+boolean prepareDeferredValues(){
+    int i, j;
+    deferredValuesPresent = FALSE;
+    for(j = 0; j < invariantCount; j++){
+        for(i = 0; i < objectCount; i++){
+            if(isDeferredValue(invariantValues[j][i])){
+                if(j == mainInvariant){
+                    fprintf(statisticsFile, "The values of the main invariant cannot be deferred.\n");
+                    return FALSE;
+                }
+                deferredValuesPresent = TRUE;
+            }
+        }
+    }
+    if(theoryProvided){
+        for(i = 0; i < objectCount; i++){
+            if(isDeferredValue(knownTheory[i])){
+                fprintf(statisticsFile, "The known theory cannot be deferred.\n");
+                return FALSE;
+            }
+        }
+    }
+    if(!deferredValuesPresent) return TRUE;
+    
+    free(objectOrder);
+    free(objectRank);
+    free(objectViolations);
+    objectOrder = (int *)malloc(sizeof(int) * objectCount);
+    objectRank = (int *)malloc(sizeof(int) * objectCount);
+    objectViolations = (unsigned long int *)calloc(objectCount, sizeof(unsigned long int));
+    if(objectOrder == NULL || objectRank == NULL || objectViolations == NULL){
+        fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+    for(i = 0; i < objectCount; i++){
+        objectOrder[i] = objectRank[i] = i;
+    }
+    return TRUE;
+}
+
 //------ Expression operations -------
 
 void outputExpressionStack(TREE *tree, FILE *f){
@@ -859,22 +1564,24 @@ void outputExpression(TREE *tree, FILE *f){
     }
 }
 
-void handleExpression(TREE *tree, double *values, int calculatedValues, int hitCount, int skipCount){
+void handleExpression(TREE *tree, double *values, int calculatedValues, int hitCount, int skipCount, double valueError){
     validExpressionsCount++;
     if(printValidExpressions){
         printExpression(tree, stderr);
     }
     if(doConjecturing){
-        if(selectedHeuristic==DALMATIAN_HEURISTIC){
-            if(skipCount > allowedPercentageOfSkips * objectCount){
+        if(selectedHeuristic==DALMATIAN_HEURISTIC ||
+                selectedHeuristic==GRINVIN_HEURISTIC){
+            if(skipCount > allowedPercentageOfSkips * weightedObjectCount){
                 return;
             }
-            dalmatianHeuristic(tree, values);
-        } else if(selectedHeuristic==GRINVIN_HEURISTIC){
-            if(skipCount > allowedPercentageOfSkips * objectCount){
-                return;
+            if(selectedHeuristic==DALMATIAN_HEURISTIC && targetCount > 0){
+                dalmatianMultiTargetHeuristic(tree, values, candidateTargetValid);
+            } else if(selectedHeuristic==DALMATIAN_HEURISTIC){
+                dalmatianHeuristic(tree, values);
+            } else {
+                grinvinHeuristic(tree, values, valueError);
             }
-            grinvinHeuristic(tree, values);
         }
     }
 }
@@ -1041,9 +1748,25 @@ boolean handleComparator(double left, double right, int id){
 
 double evaluateNode(NODE *node, int object){
     if (node->contentLabel[0]==INVARIANT_LABEL) {
-        return invariantValues[object][node->contentLabel[1]];
+        double value = invariantValues[node->contentLabel[1]][object];
+        if(deferredValuesPresent && isDeferredValue(value)){
+            value = requestDeferredValue(node->contentLabel[1], object);
+        }
+        return value;
     } else if (node->contentLabel[0]==UNARY_LABEL) {
+        if(unaryLeafColumns != NULL && node->left->contentLabel[0]==INVARIANT_LABEL){
+            double *column = unaryLeafColumns[node->contentLabel[1]*invariantCount +
+                    node->left->contentLabel[1]];
+            if(column != NULL){
+                return column[object];
+            }
+        }
+        if(valueCacheActive && cachedSubtrees[node->pos] != NULL){
+            return cachedSubtreeValue(node, object);
+        }
         return handleUnaryOperator(node->contentLabel[1], evaluateNode(node->left, object));
+    } else if (valueCacheActive && cachedSubtrees[node->pos] != NULL){
+        return cachedSubtreeValue(node, object);
     } else if (node->contentLabel[0]==NON_COMM_BINARY_LABEL){
         return handleNonCommutativeBinaryOperator(node->contentLabel[1],
                 evaluateNode(node->left, object), evaluateNode(node->right, object));
@@ -1138,84 +1861,424 @@ boolean evaluateNode_propertyBased(NODE *node, int object){
     }
 }
 
-boolean evaluateTree(TREE *tree, double *values, int *calculatedValues, int *hits, int *skips){
-    int i;
+/* Evaluates the tree for all objects and checks whether the expression is true
+ * for each object. If trackValueError is set, then the value error (i.e., the
+ * sum of the squares of the differences between the main invariant and the
+ * expression) is accumulated, and the evaluation is stopped as soon as this
+ * partial sum shows that the expression can not be stored by the grinvin
+ * heuristic. If deferred values are present, then the objects are evaluated in
+ * the order given by objectOrder.
+ */
+boolean evaluateTree(TREE *tree, double *values, int *calculatedValues, int *hits, int *skips, double *valueError){
+    int i, k;
     int hitCount = 0;
     int skipCount = 0;
-    for(i=0; i<objectCount; i++){
-        if(isnan(invariantValues[i][mainInvariant])){
-            skipCount++;
+    double error = 0.0;
+    //the objects for which the expression is known to be undefined
+    uint64_t *undefined = undefinedMasksUsed ? subtreeUndefinedMasks[tree->root->pos] : NULL;
+    for(k=0; k<objectCount; k++){
+        i = deferredValuesPresent ? objectOrder[k] : k;
+        if(isnan(invariantValues[mainInvariant][i])){
+            skipCount += OBJECT_WEIGHT(i);
             continue; //skip NaN
         }
-        double expression = evaluateNode(tree->root, i);
+        double expression = undefined != NULL && MASK_BIT(undefined, i) ?
+                NAN : evaluateNode(tree->root, i);
         values[i] = expression;
         if(isnan(expression)){
-            skipCount++;
+            skipCount += OBJECT_WEIGHT(i);
+            if(trackValueError){
+                //the value error would be NaN
+                *calculatedValues = k+1;
+                *hits = hitCount;
+                *skips = skipCount;
+                return FALSE;
+            }
             continue; //skip NaN
         }
-        if(!handleComparator(invariantValues[i][mainInvariant], expression, inequality)){
-            *calculatedValues = i+1;
+        if(!handleComparator(invariantValues[mainInvariant][i], expression, inequality)){
+            if(deferredValuesPresent){
+                objectViolations[i]++;
+            }
+            *calculatedValues = k+1;
             *hits = hitCount;
             *skips = skipCount;
             return FALSE;
-        } else if(expression==invariantValues[i][mainInvariant]) {
-            hitCount++;
+        } else if(expression==invariantValues[mainInvariant][i]) {
+            hitCount += OBJECT_WEIGHT(i);
+        }
+        if(trackValueError){
+            double diff = expression - invariantValues[mainInvariant][i];
+            error += OBJECT_WEIGHT(i)*diff*diff;
+            if(isnan(error) || error >= grinvinErrorBound){
+                *calculatedValues = k+1;
+                *hits = hitCount;
+                *skips = skipCount;
+                return FALSE;
+            }
         }
     }
     *hits = hitCount;
     *skips = skipCount;
     *calculatedValues = objectCount;
-    if(skipCount == objectCount){
+    *valueError = error;
+    if(skipCount == weightedObjectCount){
         return FALSE;
     }
     return TRUE;
 }
 
-boolean evaluateTree_propertyBased(TREE *tree, boolean *values, int *calculatedValues, int *hits, int *skips){
-    int i;
-    int hitCount = 0;
-    int skipCount = 0;
-    for(i=0; i<objectCount; i++){
-        if(invariantValues_propertyBased[i][mainInvariant]==UNDEFINED){
-            skipCount++;
-            continue; //skip undefined values
-        }
-        boolean expression = evaluateNode_propertyBased(tree->root, i);
+/* Evaluates the tree for all objects and checks for each target whether the
+ * expression is true for each object. The result for target j is stored at
+ * position j in valid. The evaluation is stopped as soon as the expression is
+ * false for all targets. Returns TRUE if the expression is valid for at least
+ * one target.
+ */
+boolean evaluateTree_multiTarget(TREE *tree, double *values, boolean *valid){
+    int i, j;
+    int skipCount[targetCount];
+    int validCount = 0;
+    for(j = 0; j < targetCount; j++){
+        DALMATIAN_TARGET *target = dalmatianTargets + j;
+        skipCount[j] = 0;
+        valid[j] = !target->stopped && 
+                (!multipleMainInvariants || allowMainInvariantInExpressions ||
+                 !invariantsUsed[target->mainInvariant]);
+        if(valid[j]) validCount++;
+    }
+    uint64_t *undefined = undefinedMasksUsed ? subtreeUndefinedMasks[tree->root->pos] : NULL;
+    for(i=0; i<objectCount && validCount > 0; i++){
+        double expression = undefined != NULL && MASK_BIT(undefined, i) ?
+                NAN : evaluateNode(tree->root, i);
         values[i] = expression;
-        if(expression == UNDEFINED){
-            skipCount++;
-            continue; //skip NaN
+        for(j = 0; j < targetCount; j++){
+            if(!valid[j]) continue;
+            double mainValue = invariantValues[dalmatianTargets[j].mainInvariant][i];
+            if(isnan(mainValue) || isnan(expression)){
+                skipCount[j] += OBJECT_WEIGHT(i); //skip NaN
+            } else if(!handleComparator(mainValue, expression, dalmatianTargets[j].inequality)){
+                valid[j] = FALSE;
+                validCount--;
+            }
         }
-        if(!handleComparator_propertyBased(invariantValues_propertyBased[i][mainInvariant], expression, inequality)){
-            *calculatedValues = i+1;
-            *hits = hitCount;
-            *skips = skipCount;
-            return FALSE;
-        } else if(!(expression) == !(invariantValues_propertyBased[i][mainInvariant])) {
-            hitCount++;
+    }
+    for(j = 0; j < targetCount; j++){
+        if(valid[j] && (skipCount[j] == weightedObjectCount ||
+                skipCount[j] > allowedPercentageOfSkips * weightedObjectCount)){
+            valid[j] = FALSE;
+            validCount--;
+        }
+    }
+    return validCount > 0;
+}
+
+/* Evaluates the tree for all objects for which the main property is defined
+ * and checks whether the expression is true for each object. The objects that
+ * can violate the expression are evaluated first. The values for the objects
+ * for which the main property is undefined are not set.
+ */
+boolean evaluateTree_propertyBased(TREE *tree, boolean *values, int *calculatedValues, int *hits, int *skips){
+    int i, j;
+    int hitCount = 0;
+    int skipCount = objectCount - definedObjectsEnd; //skip undefined values
+    int calculatedCount = 0;
+    int rangeStart[2] = {violatingObjectsStart, decidingObjectsStart};
+    int rangeEnd[2] = {violatingObjectsEnd, decidingObjectsEnd};
+    for(j=0; j<2; j++){
+        for(i=rangeStart[j]; i<rangeEnd[j]; i++){
+            boolean expression = evaluateNode_propertyBased(tree->root, i);
+            values[i] = expression;
+            calculatedCount++;
+            if(expression == UNDEFINED){
+                skipCount++;
+                continue; //skip NaN
+            }
+            if(!handleComparator_propertyBased(invariantValues_propertyBased[i][mainInvariant], expression, inequality)){
+                *calculatedValues = calculatedCount;
+                *hits = hitCount;
+                *skips = skipCount;
+                return FALSE;
+            } else if(!(expression) == !(invariantValues_propertyBased[i][mainInvariant])) {
+                hitCount++;
+            }
         }
     }
     *hits = hitCount;
     *skips = skipCount;
-    *calculatedValues = objectCount;
+    *calculatedValues = calculatedCount;
     if(skipCount == objectCount){
         return FALSE;
     }
     return TRUE;
 }
 
+//------ Value cache -------
+
+/* The value cache keeps the value vectors (one value per object) of small
+ * subexpressions, so that they are not evaluated again in each larger tree,
+ * also not at later complexity levels. A subexpression is identified by the
+ * labels of its nodes in post-order, which is canonical because the trees are
+ * generated in a canonical form. The labels are assigned in post-order, so
+ * a subtree is looked up once when the label of its root is set, and not for
+ * each labeled tree that contains it.
+ * A vector is only stored once a subexpression has been seen
+ * VALUE_CACHE_ADMISSION times, and it is filled lazily: most trees are
+ * rejected after a few objects, so the values of the later objects are only
+ * computed when a tree actually gets that far. The entries are evicted in
+ * least recently used order when the number of vectors or entries would
+ * exceed the budget given by --cache-mb. The entries that are used by the
+ * current tree are never evicted.
+ */
+VALUE_CACHE_ENTRY *valueCacheEntries = NULL;
+int *valueCacheBuckets = NULL;
+int valueCacheBucketMask;
+int valueCacheCapacity;
+int valueCacheFree;
+int valueCacheNewest;
+int valueCacheOldest;
+int valueCacheVectorCount;
+int valueCacheMaxVectors;
+
+unsigned long int valueCacheHits = 0;
+unsigned long int valueCacheMisses = 0;
+unsigned long int valueCacheStored = 0;
+unsigned long int valueCacheEvictions = 0;
+
+void clearCachedSubtrees(){
+    int i;
+    for(i = 0; i < MAX_NODES_USED; i++){
+        cachedSubtrees[i] = NULL;
+    }
+}
+
+void freeValueCache(){
+    int i;
+    if(valueCacheEntries != NULL){
+        for(i = 0; i < valueCacheCapacity; i++){
+            free(valueCacheEntries[i].values);
+        }
+    }
+    free(valueCacheEntries);
+    free(valueCacheBuckets);
+    valueCacheEntries = NULL;
+    valueCacheBuckets = NULL;
+    valueCacheActive = FALSE;
+}
+
+/* (Re)initialises the value cache for the current invariants. */
+void initValueCache(){
+    int i;
+    freeValueCache();
+    valueCacheHits = valueCacheMisses = valueCacheStored = valueCacheEvictions = 0;
+    if(valueCacheBudget == 0 || propertyBased || deferredValuesPresent) return;
+    
+    unsigned long int vectors = valueCacheBudget / (sizeof(double) * objectCount);
+    if(vectors == 0) return;
+    valueCacheMaxVectors = vectors > (1UL << 24) ? (1 << 24) : (int)vectors;
+    //the entries without a vector only count how often a subexpression is seen
+    valueCacheCapacity = 4 * valueCacheMaxVectors + 1024;
+    int bucketCount = 1;
+    while(bucketCount < valueCacheCapacity) bucketCount *= 2;
+    valueCacheBucketMask = bucketCount - 1;
+    
+    valueCacheEntries = (VALUE_CACHE_ENTRY *)malloc(sizeof(VALUE_CACHE_ENTRY) * valueCacheCapacity);
+    valueCacheBuckets = (int *)malloc(sizeof(int) * bucketCount);
+    if(valueCacheEntries == NULL || valueCacheBuckets == NULL){
+        fprintf(stderr, "Initialisation of value cache failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+    for(i = 0; i < bucketCount; i++){
+        valueCacheBuckets[i] = VALUE_CACHE_NONE;
+    }
+    for(i = 0; i < valueCacheCapacity; i++){
+        valueCacheEntries[i].values = NULL;
+        valueCacheEntries[i].next = i + 1 < valueCacheCapacity ? i + 1 : VALUE_CACHE_NONE;
+    }
+    valueCacheFree = 0;
+    valueCacheNewest = valueCacheOldest = VALUE_CACHE_NONE;
+    valueCacheVectorCount = 0;
+    clearCachedSubtrees();
+    valueCacheActive = TRUE;
+}
+
+void unlinkValueCacheEntry(int e){
+    VALUE_CACHE_ENTRY *entry = valueCacheEntries + e;
+    if(entry->older != VALUE_CACHE_NONE){
+        valueCacheEntries[entry->older].newer = entry->newer;
+    } else {
+        valueCacheOldest = entry->newer;
+    }
+    if(entry->newer != VALUE_CACHE_NONE){
+        valueCacheEntries[entry->newer].older = entry->older;
+    } else {
+        valueCacheNewest = entry->older;
+    }
+}
+
+void linkValueCacheEntry(int e){
+    VALUE_CACHE_ENTRY *entry = valueCacheEntries + e;
+    entry->older = valueCacheNewest;
+    entry->newer = VALUE_CACHE_NONE;
+    if(valueCacheNewest != VALUE_CACHE_NONE){
+        valueCacheEntries[valueCacheNewest].newer = e;
+    } else {
+        valueCacheOldest = e;
+    }
+    valueCacheNewest = e;
+}
+
+/* Evicts the least recently used entry that is not used by the current tree,
+ * and that has a vector if vectorNeeded is TRUE. Returns FALSE if there is no
+ * such entry.
+ */
+boolean evictValueCacheEntry(boolean vectorNeeded){
+    int e = valueCacheOldest;
+    while(e != VALUE_CACHE_NONE && (cachedSubtrees[valueCacheEntries[e].pos] == valueCacheEntries + e ||
+            (vectorNeeded && valueCacheEntries[e].values == NULL))){
+        e = valueCacheEntries[e].newer;
+    }
+    if(e == VALUE_CACHE_NONE) return FALSE;
+    
+    VALUE_CACHE_ENTRY *entry = valueCacheEntries + e;
+    if(entry->values != NULL){
+        free(entry->values);
+        entry->values = NULL;
+        valueCacheVectorCount--;
+        valueCacheEvictions++;
+        if(vectorNeeded) return TRUE; //the entry itself is kept for its counts
+    }
+    int *link = valueCacheBuckets + (entry->hash & valueCacheBucketMask);
+    while(*link != e){
+        link = &(valueCacheEntries[*link].next);
+    }
+    *link = entry->next;
+    unlinkValueCacheEntry(e);
+    entry->next = valueCacheFree;
+    valueCacheFree = e;
+    return TRUE;
+}
+
+int collectSubtreeLabels(NODE *node, int labels[][2], int length){
+    if(node->type >= 1){
+        length = collectSubtreeLabels(node->left, labels, length);
+    }
+    if(node->type == 2 && length >= 0){
+        length = collectSubtreeLabels(node->right, labels, length);
+    }
+    if(length < 0 || length == VALUE_CACHE_MAX_NODES) return -1;
+    labels[length][0] = node->contentLabel[0];
+    labels[length][1] = node->contentLabel[1];
+    return length + 1;
+}
+
+/* Returns the value of the subtree rooted at the given node for the given
+ * object, and stores the values up to that object in the cache entry of the
+ * subtree.
+ */
+double cachedSubtreeValue(NODE *node, int object){
+    VALUE_CACHE_ENTRY *entry = cachedSubtrees[node->pos];
+    if(object < entry->filled){
+        return entry->values[object];
+    }
+    cachedSubtrees[node->pos] = NULL;
+    while(entry->filled <= object){
+        entry->values[entry->filled] = evaluateNode(node, entry->filled);
+        entry->filled++;
+    }
+    cachedSubtrees[node->pos] = entry;
+    return entry->values[object];
+}
+
+/* Looks up the subtree rooted at the given node, whose label has just been
+ * set, in the value cache, and sets its entry in cachedSubtrees if it has a
+ * value vector.
+ */
+void lookupCachedSubtree(NODE *node){
+    int i;
+    cachedSubtrees[node->pos] = NULL;
+    if(node->type == 1 && node->left->type == 0 && unaryLeafColumns != NULL){
+        return; //this column is already precomputed
+    }
+    
+    int labels[VALUE_CACHE_MAX_NODES][2];
+    int length = collectSubtreeLabels(node, labels, 0);
+    if(length < 0) return;
+    uint64_t hash = 14695981039346656037ULL; //FNV-1a
+    for(i = 0; i < length; i++){
+        hash = (hash ^ (uint64_t)(labels[i][0] * 1024 + labels[i][1])) * 1099511628211ULL;
+    }
+    int e = valueCacheBuckets[hash & valueCacheBucketMask];
+    while(e != VALUE_CACHE_NONE && (valueCacheEntries[e].hash != hash ||
+            valueCacheEntries[e].length != length ||
+            memcmp(valueCacheEntries[e].labels, labels, sizeof(int) * 2 * length))){
+        e = valueCacheEntries[e].next;
+    }
+    if(e == VALUE_CACHE_NONE){
+        valueCacheMisses++;
+        if(valueCacheFree == VALUE_CACHE_NONE && !evictValueCacheEntry(FALSE)){
+            return;
+        }
+        e = valueCacheFree;
+        VALUE_CACHE_ENTRY *entry = valueCacheEntries + e;
+        valueCacheFree = entry->next;
+        memcpy(entry->labels, labels, sizeof(int) * 2 * length);
+        entry->length = length;
+        entry->hash = hash;
+        entry->uses = 1;
+        entry->pos = node->pos;
+        entry->next = valueCacheBuckets[hash & valueCacheBucketMask];
+        valueCacheBuckets[hash & valueCacheBucketMask] = e;
+        linkValueCacheEntry(e);
+        return;
+    }
+    VALUE_CACHE_ENTRY *entry = valueCacheEntries + e;
+    if(valueCacheNewest != e){
+        unlinkValueCacheEntry(e);
+        linkValueCacheEntry(e);
+    }
+    entry->uses++;
+    
+    if(entry->values == NULL){
+        valueCacheMisses++;
+        if(entry->uses < VALUE_CACHE_ADMISSION) return;
+        if(valueCacheVectorCount == valueCacheMaxVectors && !evictValueCacheEntry(TRUE)){
+            return;
+        }
+        entry->values = (double *)malloc(sizeof(double) * objectCount);
+        if(entry->values == NULL){
+            fprintf(stderr, "Value cache failed: insufficient memory -- exiting!\n");
+            exit(EXIT_FAILURE);
+        }
+        entry->filled = 0;
+        valueCacheVectorCount++;
+        valueCacheStored++;
+    } else {
+        valueCacheHits++;
+    }
+    entry->pos = node->pos;
+    cachedSubtrees[node->pos] = entry;
+}
+
 void checkExpression(TREE *tree){
-    double values[objectCount];
+    double *values = candidateValues;
     int calculatedValues = 0;
     int hitCount = 0;
     int skipCount = 0;
-    if (evaluateTree(tree, values, &calculatedValues, &hitCount, &skipCount)){
-        handleExpression(tree, values, objectCount, hitCount, skipCount);
+    double valueError = 0.0;
+    if(targetCount > 0){
+        //the skips are already checked for each target
+        if(evaluateTree_multiTarget(tree, values, candidateTargetValid)){
+            handleExpression(tree, values, objectCount, 0, 0, valueError);
+        }
+        return;
+    }
+    if (evaluateTree(tree, values, &calculatedValues, &hitCount, &skipCount, &valueError)){
+        handleExpression(tree, values, objectCount, hitCount, skipCount, valueError);
     }
 }
 
 void checkExpression_propertyBased(TREE *tree){
-    boolean values[objectCount];
+    boolean *values = candidateValues_propertyBased;
     int calculatedValues = 0;
     int hitCount = 0;
     int skipCount = 0;
@@ -1240,13 +2303,117 @@ void handleLabeledTree(TREE *tree){
     }
 }
 
-boolean leftSideBiggest(NODE *node, NODE **orderedNodes){
-    NODE *leftMost = node->left;
+/* Checks whether an expression that is undefined for the given (weighted)
+ * number of objects for which the main invariant is defined, can still be
+ * accepted.
+ */
+boolean tooManyUndefinedValues(int undefinedCount, int mainSkipCount){
+    if(trackValueError && targetCount == 0 && undefinedCount > 0){
+        return TRUE; //the value error would be NaN
+    }
+    int skipCount = undefinedCount + mainSkipCount;
+    return skipCount == weightedObjectCount ||
+            skipCount > allowedPercentageOfSkips * weightedObjectCount;
+}
+
+/* Returns the weight of the objects in the given bitset for which the main
+ * invariant is defined.
+ */
+int countUndefinedObjects(uint64_t *mask){
+    int w, count = 0;
+    for(w = 0; w < maskWordCount; w++){
+        uint64_t bits = mask[w];
+        if(mainUndefinedMask != NULL){
+            bits &= ~mainUndefinedMask[w];
+        }
+        if(objectMultiplicity == NULL){
+            count += __builtin_popcountll(bits);
+        } else {
+            while(bits){
+                count += objectMultiplicity[64*w + __builtin_ctzll(bits)];
+                bits &= bits - 1;
+            }
+        }
+    }
+    return count;
+}
+
+/* Determines whether the subtree rooted at the given node, which has just
+ * been labeled, is undefined for too many objects. Unary operators, +, *, -
+ * and / are undefined whenever an argument is undefined. This holds for max
+ * only for its left argument and for min only for its right argument, because
+ * of the way they are evaluated, and it does not hold for ^. Returns TRUE if
+ * the labeling can be skipped: this is the case if the tree is complete, or if
+ * none of the operators in use can make the subtree defined again.
+ */
+boolean exceedsAllowedSkips(TREE *tree, NODE *node){
+    boolean exceeds;
+    uint64_t *mask = NULL;
+    if(node->type == 0){
+        exceeds = leafExceedsSkips[node->contentLabel[1]];
+        if(undefinedMasksUsed){
+            mask = leafUndefinedMasks[node->contentLabel[1]];
+        }
+    } else if(node->type == 1 && node->left->type == 0){
+        int id = node->contentLabel[1]*invariantCount + node->left->contentLabel[1];
+        exceeds = unaryLeafExceedsSkips[id];
+        if(undefinedMasksUsed){
+            mask = unaryLeafUndefinedMasks[id];
+        }
+    } else {
+        //the arguments that make this node undefined
+        NODE *left = node->left;
+        NODE *right = node->type == 2 ? node->right : NULL;
+        if(node->contentLabel[0] == NON_COMM_BINARY_LABEL && node->contentLabel[1] == 2){
+            left = right = NULL;
+        } else if(node->contentLabel[0] == COMM_BINARY_LABEL && node->contentLabel[1] == 2){
+            right = NULL;
+        } else if(node->contentLabel[0] == COMM_BINARY_LABEL && node->contentLabel[1] == 3){
+            left = NULL;
+        }
+        exceeds = (left != NULL && subtreeExceedsSkips[left->pos]) ||
+                (right != NULL && subtreeExceedsSkips[right->pos]);
+        if(undefinedMasksUsed){
+            uint64_t *leftMask = left == NULL ? NULL : subtreeUndefinedMasks[left->pos];
+            uint64_t *rightMask = right == NULL ? NULL : subtreeUndefinedMasks[right->pos];
+            if(leftMask == NULL){
+                mask = rightMask;
+            } else if(rightMask == NULL){
+                mask = leftMask;
+            } else {
+                int w;
+                mask = subtreeMaskValues + node->pos * maskWordCount;
+                for(w = 0; w < maskWordCount; w++){
+                    mask[w] = leftMask[w] | rightMask[w];
+                }
+                if(!exceeds){
+                    exceeds = tooManyUndefinedValues(countUndefinedObjects(mask), mainSkipCount);
+                }
+            }
+        }
+    }
+    subtreeExceedsSkips[node->pos] = exceeds;
+    subtreeUndefinedMasks[node->pos] = mask;
+    if(exceeds && (node == tree->root || !nanAbsorbingOperators)){
+        skippedLabelingCount++;
+        return TRUE;
+    }
+    return FALSE;
+}
+
+/* Compares two labeled subtrees: first by size and then by their labels in
+ * post-order. Returns TRUE if the first subtree is at least as big as the
+ * second one.
+ */
+boolean firstSubtreeBiggest(NODE *first, NODE *second, NODE **orderedNodes){
+    NODE *leftMost = first;
     while (leftMost->left != NULL) leftMost = leftMost->left;
     int startLeft = leftMost->pos;
-    int startRight = node->left->pos+1;
-    int lengthLeft = startRight - startLeft;
-    int lengthRight = node->pos - startRight;
+    leftMost = second;
+    while (leftMost->left != NULL) leftMost = leftMost->left;
+    int startRight = leftMost->pos;
+    int lengthLeft = first->pos + 1 - startLeft;
+    int lengthRight = second->pos + 1 - startRight;
     
     if(lengthLeft > lengthRight){
         return TRUE;
@@ -1266,8 +2433,38 @@ boolean leftSideBiggest(NODE *node, NODE **orderedNodes){
     }
 }
 
+boolean leftSideBiggest(NODE *node, NODE **orderedNodes){
+    return firstSubtreeBiggest(node->left, node->right, orderedNodes);
+}
+
+/* A chain of the same associative commutative operator can be bracketed and
+ * ordered in any way, so only one form is generated: the chain is bracketed to
+ * the left, i.e., the right argument never uses the same operator, and the
+ * arguments of the chain appear in the order used by leftSideBiggest. Returns
+ * TRUE if the chain ending at the given node, which has just been labeled
+ * with a commutative operator, is in this form. The other forms of a chain of
+ * + or * can differ in the last bits due to rounding. max and min are left
+ * alone: they only pass an undefined value from one of their arguments, so the
+ * order of their arguments matters.
+ */
+boolean isCanonicalChain(NODE *node, NODE **orderedNodes){
+    int id = node->contentLabel[1];
+    if(!propertyBased && (id == 2 || id == 3)){
+        return TRUE;
+    }
+    if(node->right->contentLabel[0] == COMM_BINARY_LABEL && node->right->contentLabel[1] == id){
+        return FALSE;
+    }
+    if(node->left->contentLabel[0] == COMM_BINARY_LABEL && node->left->contentLabel[1] == id){
+        //the last argument of the chain on the left should be at least as big
+        //as the new argument on the right
+        return firstSubtreeBiggest(node->left->right, node->right, orderedNodes);
+    }
+    return TRUE;
+}
+
 void generateLabeledTree(TREE *tree, NODE **orderedNodes, int pos){
-    int i;
+    int i, k;
     
     if (pos == targetUnary + 2*targetBinary + 1){
         handleLabeledTree(tree);
@@ -1275,9 +2472,13 @@ void generateLabeledTree(TREE *tree, NODE **orderedNodes, int pos){
         NODE *currentNode = orderedNodes[pos];
         if (currentNode->type == 0){
             currentNode->contentLabel[0] = INVARIANT_LABEL;
-            for (i=0; i<invariantCount; i++){
+            for (k=0; k<invariantCount; k++){
+                i = invariantOrder[k];
                 if (!invariantsUsed[i]){
                     currentNode->contentLabel[1] = i;
+                    if(skipUndefinedLabelings && exceedsAllowedSkips(tree, currentNode)){
+                        continue;
+                    }
                     invariantsUsed[i] = TRUE;
                     generateLabeledTree(tree, orderedNodes, pos+1);
                     invariantsUsed[i] = FALSE;
@@ -1290,6 +2491,12 @@ void generateLabeledTree(TREE *tree, NODE **orderedNodes, int pos){
             currentNode->contentLabel[0] = UNARY_LABEL;
             for (i=0; i<unaryOperatorCount; i++){
                 currentNode->contentLabel[1] = unaryOperators[i];
+                if(skipUndefinedLabelings && exceedsAllowedSkips(tree, currentNode)){
+                    continue;
+                }
+                if(valueCacheActive && currentNode != tree->root){
+                    lookupCachedSubtree(currentNode);
+                }
                 generateLabeledTree(tree, orderedNodes, pos+1);
                 if(shouldGenerationProcessBeTerminated()){
                     return;
@@ -1300,6 +2507,12 @@ void generateLabeledTree(TREE *tree, NODE **orderedNodes, int pos){
             currentNode->contentLabel[0] = NON_COMM_BINARY_LABEL;
             for (i=0; i<nonCommBinaryOperatorCount; i++){
                 currentNode->contentLabel[1] = nonCommBinaryOperators[i];
+                if(skipUndefinedLabelings && exceedsAllowedSkips(tree, currentNode)){
+                    continue;
+                }
+                if(valueCacheActive && currentNode != tree->root){
+                    lookupCachedSubtree(currentNode);
+                }
                 generateLabeledTree(tree, orderedNodes, pos+1);
                 if(shouldGenerationProcessBeTerminated()){
                     return;
@@ -1311,6 +2524,15 @@ void generateLabeledTree(TREE *tree, NODE **orderedNodes, int pos){
                 currentNode->contentLabel[0] = COMM_BINARY_LABEL;
                 for (i=0; i<commBinaryOperatorCount; i++){
                     currentNode->contentLabel[1] = commBinaryOperators[i];
+                    if(!isCanonicalChain(currentNode, orderedNodes)){
+                        continue;
+                    }
+                    if(skipUndefinedLabelings && exceedsAllowedSkips(tree, currentNode)){
+                        continue;
+                    }
+                    if(valueCacheActive && currentNode != tree->root){
+                        lookupCachedSubtree(currentNode);
+                    }
                     generateLabeledTree(tree, orderedNodes, pos+1);
                     if(shouldGenerationProcessBeTerminated()){
                         return;
@@ -1333,16 +2555,29 @@ void handleTree(TREE *tree){
     int pos = 0;
     getOrderedNodes(tree->root, orderedNodes, &pos);
     
+    if(valueCacheActive){
+        clearCachedSubtrees();
+    }
+    
     //mark all invariants as unused
     int i;
     for (i=0; i<invariantCount; i++){
         invariantsUsed[i] = FALSE;
     }
     
-    if(!allowMainInvariantInExpressions){
+    if(!allowMainInvariantInExpressions && !multipleMainInvariants){
         invariantsUsed[mainInvariant] = TRUE;
     }
     
+    //pruned invariants are never used
+    if(prunedInvariantCount > 0){
+        for (i=0; i<invariantCount; i++){
+            if(invariantPruned[i]){
+                invariantsUsed[i] = TRUE;
+            }
+        }
+    }
+    
     generateLabeledTree(tree, orderedNodes, 0);
 }
 
@@ -1394,9 +2629,16 @@ void generateTree(int unary, int binary){
     if(report_maximum_complexity_reached){//no need to check if this is larger since we generate them in increasing order
         maximum_complexity_reached = 2*binary + unary;
     }
+    streamLevelEvent(unary, binary);
     TREE tree;
     targetUnary = unary;
     targetBinary = binary;
+    //the stop condition of some heuristics depends on the target counts
+    updateHeuristicStopCondition();
+    //the objects which rejected the most expressions are evaluated first
+    if(deferredValuesPresent && !trackValueError){
+        updateObjectOrder();
+    }
     initTree(&tree);
     
     if (unary==0 && binary==0){
@@ -1441,7 +2683,9 @@ void getNextOperatorCount(int *unary, int *binary){
 void conjecture(int startUnary, int startBinary){
     int unary = startUnary;
     int binary = startBinary;
-    int availableInvariants = invariantCount - (allowMainInvariantInExpressions ? 0 : 1);
+    int availableInvariants = invariantCount - 
+            (allowMainInvariantInExpressions || multipleMainInvariants ? 0 : 1) -
+            prunedInvariantCount;
     
     generateTree(unary, binary);
     getNextOperatorCount(&unary, &binary);
@@ -1573,7 +2817,9 @@ void allocateMemory_invariantBased(){
     
     allocateMemory_shared();
 
-    invariantValues = (double **)malloc(sizeof(double *) * objectCount);
+    //the values are stored column by column: invariantValues[j][i] is the
+    //value of invariant j for object i
+    invariantValues = (double **)malloc(sizeof(double *) * invariantCount);
     if(invariantValues == NULL){
         fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
         exit(EXIT_FAILURE);
@@ -1583,8 +2829,8 @@ void allocateMemory_invariantBased(){
         fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
         exit(EXIT_FAILURE);
     }
-    for(i = 0; i < objectCount; i++){
-        invariantValues[i] = (*invariantValues + invariantCount * i);
+    for(i = 0; i < invariantCount; i++){
+        invariantValues[i] = (*invariantValues + objectCount * i);
     }
     
     knownTheory = (double *)malloc(sizeof(double) * objectCount);
@@ -1619,13 +2865,223 @@ void allocateMemory_propertyBased(){
         fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
         exit(EXIT_FAILURE);
     }
+    
+    objectNumbers = (int *)malloc(sizeof(int) * objectCount);
+    if(objectNumbers == NULL){
+        fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+    for(i = 0; i < objectCount; i++){
+        objectNumbers[i] = i + 1;
+    }
+
+}
+
+/* Binary invariants format
+ * 
+ * A binary invariants file starts with the 8 bytes "\211EXPRINV" followed by
+ * four 32-bit integers in native byte order: the number of objects, the number
+ * of invariants, the (one-based) number of the main invariant and a set of
+ * flags (1: the file contains the invariant names, 2: the file contains the
+ * known theory). If the file contains the invariant names, then each name is
+ * given as a 32-bit integer with its length followed by the characters of the
+ * name (without a terminating zero). After this header the file is padded with
+ * zeroes to a multiple of 8 bytes. Then the known theory follows as one double
+ * per object (if present) and finally the invariant values are given as
+ * doubles column by column: first the values of the first invariant for all
+ * objects, then the values of the second invariant, and so on.
+ * 
+ * Since this is also the way the invariant values are stored internally, a
+ * binary invariants file that is a regular file is mapped into memory and used
+ * directly.
+ * 
+ * An invariant value (but not a value of the main invariant or of the known
+ * theory) can also be deferred: see DEFERRED_VALUE_BITS and --demand-pipes.
+ * 
+ * For property-based conjectures the values can also be packed (flag 4). The
+ * known theory and each property are then given by two bit vectors which are
+ * padded to a multiple of 64 bits: the first one has bit i set if the value
+ * for object i is defined, the second one has bit i set if that value is true.
+ * Bit i is stored in byte i/8 at position i%8 (least significant bit first).
+ */
+#define BINARY_INVARIANTS_MAGIC "\211EXPRINV"
+#define BINARY_INVARIANTS_MAGIC_LENGTH 8
+
+#define BINARY_INVARIANTS_NAMES 1
+#define BINARY_INVARIANTS_THEORY 2
+#define BINARY_INVARIANTS_PACKED 4
+
+char *binaryInvariantsData;
+size_t binaryInvariantsSize;
+size_t binaryInvariantsCapacity;
+boolean binaryInvariantsMapped = FALSE;
+
+boolean isBinaryInvariantsFile(){
+    int c = getc(invariantsFile);
+    if(c == EOF){
+        return FALSE;
+    }
+    ungetc(c, invariantsFile);
+    return c == (unsigned char)BINARY_INVARIANTS_MAGIC[0];
+}
+
+/* Makes the remainder of the invariants file available in binaryInvariantsData.
+ * A regular file is mapped into memory, otherwise the data is read from the file
+ * when it is needed, so that no more data is read than the invariants file
+ * contains (e.g., when the data is written to a pipe that is not closed).
+ */
+void loadBinaryInvariantsFile(){
+    struct stat fileStatus;
+    long position = ftell(invariantsFile);
+    
+    if(position >= 0 && position % sizeof(double) == 0 &&
+            fstat(fileno(invariantsFile), &fileStatus) == 0 &&
+            S_ISREG(fileStatus.st_mode) && fileStatus.st_size > position){
+        //the file is mapped privately, so the values can be changed in memory
+        char *mapping = mmap(NULL, fileStatus.st_size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE, fileno(invariantsFile), 0);
+        if(mapping != MAP_FAILED){
+            binaryInvariantsData = mapping + position;
+            binaryInvariantsSize = fileStatus.st_size - position;
+            binaryInvariantsMapped = TRUE;
+            return;
+        }
+    }
+    
+    binaryInvariantsSize = 0;
+    binaryInvariantsCapacity = 1 << 16;
+    binaryInvariantsData = (char *)malloc(binaryInvariantsCapacity);
+    if(binaryInvariantsData == NULL){
+        fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/* Returns a pointer to the next field of the given length in the binary
+ * invariants file. The pointer is only valid until the next call of this
+ * function.
+ */
+void *nextBinaryInvariantsField(size_t *position, size_t length){
+    if(!binaryInvariantsMapped && length > binaryInvariantsSize - *position){
+        size_t requiredSize = *position + length;
+        if(requiredSize > binaryInvariantsCapacity){
+            while(requiredSize > binaryInvariantsCapacity){
+                binaryInvariantsCapacity *= 2;
+            }
+            binaryInvariantsData = (char *)realloc(binaryInvariantsData, binaryInvariantsCapacity);
+            if(binaryInvariantsData == NULL){
+                fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        binaryInvariantsSize += fread(binaryInvariantsData + binaryInvariantsSize, 1,
+                requiredSize - binaryInvariantsSize, invariantsFile);
+    }
+    if(length > binaryInvariantsSize - *position){
+        BAILOUT("Error while reading invariants: binary file is too short")
+    }
+    void *field = binaryInvariantsData + *position;
+    *position += length;
+    return field;
+}
+
+/* Reads the header of a binary invariants file up to and including the
+ * padding, and returns the flags. The memory for the invariants is allocated
+ * by the given function.
+ */
+int readBinaryInvariantsHeader(size_t *position, void (*allocateMemory)(void)){
+    int j;
+    int32_t header[4];
+    
+    loadBinaryInvariantsFile();
+    
+    if(memcmp(nextBinaryInvariantsField(position, BINARY_INVARIANTS_MAGIC_LENGTH),
+            BINARY_INVARIANTS_MAGIC, BINARY_INVARIANTS_MAGIC_LENGTH)){
+        BAILOUT("Error while reading invariants: not a binary invariants file")
+    }
+    memcpy(header, nextBinaryInvariantsField(position, sizeof(header)), sizeof(header));
+    objectCount = header[0];
+    invariantCount = header[1];
+    mainInvariant = header[2] - 1; //internally we work zero-based
+    int flags = header[3];
+    if(objectCount <= 0 || invariantCount <= 0 ||
+            mainInvariant < 0 || mainInvariant >= invariantCount){
+        BAILOUT("Error while reading invariants")
+    }
+    
+    allocateMemory();
+    
+    if(flags & BINARY_INVARIANTS_NAMES){
+        for(j=0; j<invariantCount; j++){
+            int32_t length;
+            memcpy(&length, nextBinaryInvariantsField(position, sizeof(length)), sizeof(length));
+            if(length < 0 || length >= 1024){
+                BAILOUT("Error while reading invariant names")
+            }
+            memcpy(invariantNames[j], nextBinaryInvariantsField(position, length), length);
+            invariantNames[j][length] = '\0';
+            invariantNamesPointers[j] = invariantNames[j];
+        }
+    } else if(useInvariantNames){
+        BAILOUT("Error while reading invariant names")
+    }
+    
+    if(theoryProvided && !(flags & BINARY_INVARIANTS_THEORY)){
+        BAILOUT("Error while reading known theory")
+    }
+    
+    nextBinaryInvariantsField(position, (sizeof(double) - *position % sizeof(double)) % sizeof(double));
+    
+    return flags;
+}
+
+void allocateMemory_binaryInvariantBased(){
+    allocateMemory_shared();
+    
+    //the values themselves are not copied: the columns point into the file
+    invariantValues = (double **)malloc(sizeof(double *) * invariantCount);
+    if(invariantValues == NULL){
+        fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+}
 
+void readBinaryInvariantsValues(){
+    int j;
+    size_t position = 0;
+    
+    int flags = readBinaryInvariantsHeader(&position, allocateMemory_binaryInvariantBased);
+    
+    if(flags & BINARY_INVARIANTS_PACKED){
+        BAILOUT("Error while reading invariants: packed values can only be used for properties")
+    }
+    
+    size_t theoryPosition = position;
+    if(flags & BINARY_INVARIANTS_THEORY){
+        nextBinaryInvariantsField(&position, sizeof(double) * objectCount);
+    }
+    size_t valuesPosition = position;
+    nextBinaryInvariantsField(&position, sizeof(double) * objectCount * (size_t)invariantCount);
+    
+    //all data is available now, so the pointers will remain valid
+    if(flags & BINARY_INVARIANTS_THEORY){
+        knownTheory = (double *)(binaryInvariantsData + theoryPosition);
+    }
+    for(j=0; j<invariantCount; j++){
+        invariantValues[j] = (double *)(binaryInvariantsData + valuesPosition) +
+                (size_t)objectCount * j;
+    }
 }
 
 void readInvariantsValues(){
     int i,j;
     char line[1024]; //array to temporarily store a line
     
+    if(isBinaryInvariantsFile()){
+        readBinaryInvariantsValues();
+        return;
+    }
+    
     //first read number of invariants and number of entities
     if(fgets(line, sizeof(line), invariantsFile)){
         if(sscanf(line, "%d %d %d", &objectCount, &invariantCount, &mainInvariant) != 3) {
@@ -1674,7 +3130,7 @@ void readInvariantsValues(){
                 if(sscanf(line, "%lf", &value) != 1) {
                     BAILOUT("Error while reading invariants")
                 }
-                invariantValues[i][j] = value;
+                invariantValues[j][i] = value;
             } else {
                 BAILOUT("Error while reading invariants")
             }
@@ -1682,10 +3138,141 @@ void readInvariantsValues(){
     }
 }
 
+/* Reorders the objects so that the objects that have the main property come
+ * first, followed by the objects that do not have the main property and finally
+ * the objects for which the main property is undefined. The original order of
+ * the objects inside each part is kept. The objects can be partitioned again
+ * after the main invariant has been changed.
+ */
+void partitionObjects_propertyBased(){
+    int i;
+    int part;
+    int position = 0;
+    boolean *originalValues[objectCount];
+    boolean originalTheory[objectCount];
+    
+    for(i = 0; i < objectCount; i++){
+        originalValues[objectNumbers[i] - 1] = invariantValues_propertyBased[i];
+        originalTheory[objectNumbers[i] - 1] = knownTheory_propertyBased[i];
+    }
+    
+    for(part = 0; part < 3; part++){
+        for(i = 0; i < objectCount; i++){
+            boolean mainValue = originalValues[i][mainInvariant];
+            if((part == 0 && mainValue == TRUE) ||
+                    (part == 1 && mainValue == FALSE) ||
+                    (part == 2 && mainValue == UNDEFINED)){
+                invariantValues_propertyBased[position] = originalValues[i];
+                knownTheory_propertyBased[position] = originalTheory[i];
+                objectNumbers[position] = i + 1;
+                position++;
+            }
+        }
+        if(part == 0){
+            mainPropertyEnd = position;
+        } else if(part == 1){
+            definedObjectsEnd = position;
+        }
+    }
+    
+    if(inequality == NECESSARY){
+        violatingObjectsStart = 0;
+        violatingObjectsEnd = mainPropertyEnd;
+        decidingObjectsStart = mainPropertyEnd;
+        decidingObjectsEnd = definedObjectsEnd;
+    } else {
+        violatingObjectsStart = mainPropertyEnd;
+        violatingObjectsEnd = definedObjectsEnd;
+        decidingObjectsStart = 0;
+        decidingObjectsEnd = mainPropertyEnd;
+    }
+}
+
+/* Converts a value from a binary invariants file or a CSV file to a property
+ * value. Returns FALSE if the value is not a valid property value.
+ */
+boolean convertPropertyValue(double value, boolean *property){
+    if(isnan(value)){
+        *property = UNDEFINED;
+    } else if(value == 0.0){
+        *property = FALSE;
+    } else if(value == 1.0){
+        *property = TRUE;
+    } else {
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/* Returns the value for the given object in a packed property (see the
+ * description of the binary invariants format).
+ */
+boolean packedPropertyValue(unsigned char *bits, size_t packedSize, int object){
+    unsigned char mask = 1 << (object & 7);
+    if(!(bits[object >> 3] & mask)){
+        return UNDEFINED;
+    }
+    return (bits[packedSize + (object >> 3)] & mask) ? TRUE : FALSE;
+}
+
+void readBinaryInvariantsValues_propertyBased(){
+    int i,j;
+    size_t position = 0;
+    
+    int flags = readBinaryInvariantsHeader(&position, allocateMemory_propertyBased);
+    
+    if(flags & BINARY_INVARIANTS_PACKED){
+        size_t packedSize = sizeof(uint64_t) * ((objectCount + 63) / 64);
+        if(flags & BINARY_INVARIANTS_THEORY){
+            unsigned char *bits = (unsigned char *)nextBinaryInvariantsField(&position,
+                    2 * packedSize);
+            for(i=0; i<objectCount; i++){
+                knownTheory_propertyBased[i] = packedPropertyValue(bits, packedSize, i);
+            }
+        }
+        for(j=0; j<invariantCount; j++){
+            unsigned char *bits = (unsigned char *)nextBinaryInvariantsField(&position,
+                    2 * packedSize);
+            for(i=0; i<objectCount; i++){
+                invariantValues_propertyBased[i][j] = packedPropertyValue(bits, packedSize, i);
+            }
+        }
+        partitionObjects_propertyBased();
+        return;
+    }
+    
+    if(flags & BINARY_INVARIANTS_THEORY){
+        double *theory = (double *)nextBinaryInvariantsField(&position,
+                sizeof(double) * objectCount);
+        for(i=0; i<objectCount; i++){
+            if(!convertPropertyValue(theory[i], knownTheory_propertyBased + i)){
+                BAILOUT("Error while reading known theory")
+            }
+        }
+    }
+    
+    for(j=0; j<invariantCount; j++){
+        double *column = (double *)nextBinaryInvariantsField(&position,
+                sizeof(double) * objectCount);
+        for(i=0; i<objectCount; i++){
+            if(!convertPropertyValue(column[i], invariantValues_propertyBased[i] + j)){
+                BAILOUT("Error while reading invariants")
+            }
+        }
+    }
+    
+    partitionObjects_propertyBased();
+}
+
 void readInvariantsValues_propertyBased(){
     int i,j;
     char line[1024]; //array to temporarily store a line
     
+    if(isBinaryInvariantsFile()){
+        readBinaryInvariantsValues_propertyBased();
+        return;
+    }
+    
     //first read number of invariants and number of entities
     if(fgets(line, sizeof(line), invariantsFile)){
         if(sscanf(line, "%d %d %d", &objectCount, &invariantCount, &mainInvariant) != 3) {
@@ -1752,6 +3339,169 @@ void readInvariantsValues_propertyBased(){
             }
         }
     }
+    
+    partitionObjects_propertyBased();
+}
+
+/* Marks the columns in the comma-separated list of column names (or numbers).
+ */
+void markCSVColumns(CSVFILE *csv, char *list, boolean *marked){
+    char listCopy[strlen(list) + 1];
+    strcpy(listCopy, list);
+    char *column = strtok(listCopy, ",");
+    while(column != NULL){
+        int index = findCSVColumn(csv, trim(column));
+        if(index < 0){
+            fprintf(stderr, "Unknown column in CSV file: %s -- exiting!\n", column);
+            exit(EXIT_FAILURE);
+        }
+        marked[index] = TRUE;
+        column = strtok(NULL, ",");
+    }
+}
+
+int findCSVColumnOrExit(CSVFILE *csv, char *column){
+    int index = findCSVColumn(csv, column);
+    if(index < 0){
+        fprintf(stderr, "Unknown column in CSV file: %s -- exiting!\n", column);
+        exit(EXIT_FAILURE);
+    }
+    return index;
+}
+
+void openCSVInvariantsFile(CSVFILE *csv){
+    openCSVFile(csv, csvFilename, threadCount);
+    if(csv->rowCount == 0){
+        BAILOUT("Error while reading CSV file: no rows")
+    }
+}
+
+/* Determines which columns of the CSV file are used as invariants. The indices
+ * of these columns are stored in columns, followed by the index of the known
+ * theory column if known theory is provided. Returns the number of columns
+ * that should be read.
+ */
+int selectCSVColumns(CSVFILE *csv, int *columns){
+    int j;
+    
+    int mainColumn = 0;
+    if(csvMainColumn != NULL){
+        mainColumn = findCSVColumnOrExit(csv, csvMainColumn);
+    }
+    int theoryColumn = -1;
+    if(theoryProvided){
+        if(csvTheoryColumn == NULL){
+            BAILOUT("Known theory in a CSV file requires the option --theory-column")
+        }
+        theoryColumn = findCSVColumnOrExit(csv, csvTheoryColumn);
+        if(theoryColumn == mainColumn){
+            BAILOUT("The known theory column can not be the main invariant column")
+        }
+    }
+    
+    boolean included[csv->columnCount];
+    boolean excluded[csv->columnCount];
+    for(j = 0; j < csv->columnCount; j++){
+        included[j] = (csvIncludedColumns == NULL);
+        excluded[j] = FALSE;
+    }
+    if(csvIncludedColumns != NULL){
+        markCSVColumns(csv, csvIncludedColumns, included);
+    }
+    if(csvExcludedColumns != NULL){
+        markCSVColumns(csv, csvExcludedColumns, excluded);
+    }
+    
+    //the main invariant is always used
+    invariantCount = 0;
+    for(j = 0; j < csv->columnCount; j++){
+        if(j == mainColumn){
+            mainInvariant = invariantCount;
+            columns[invariantCount++] = j;
+        } else if(j != theoryColumn && included[j] && !excluded[j]){
+            columns[invariantCount++] = j;
+        }
+    }
+    objectCount = csv->rowCount;
+    
+    if(theoryColumn >= 0){
+        columns[invariantCount] = theoryColumn;
+        return invariantCount + 1;
+    }
+    return invariantCount;
+}
+
+void copyCSVInvariantNames(CSVFILE *csv, int *columns){
+    int j;
+    for(j = 0; j < invariantCount; j++){
+        strncpy(invariantNames[j], csv->columnNames[columns[j]], 1023);
+        invariantNames[j][1023] = '\0';
+        invariantNamesPointers[j] = invariantNames[j];
+    }
+}
+
+void readCSVValues(){
+    CSVFILE csv;
+    openCSVInvariantsFile(&csv);
+    
+    int columns[csv.columnCount + 1];
+    int count = selectCSVColumns(&csv, columns);
+    
+    allocateMemory_invariantBased();
+    copyCSVInvariantNames(&csv, columns);
+    
+    double *values[count];
+    memcpy(values, invariantValues, sizeof(double *) * invariantCount);
+    if(count > invariantCount){
+        values[invariantCount] = knownTheory;
+    }
+    readCSVColumns(&csv, columns, count, values);
+    
+    closeCSVFile(&csv);
+}
+
+void readCSVValues_propertyBased(){
+    int i,j;
+    CSVFILE csv;
+    openCSVInvariantsFile(&csv);
+    
+    int columns[csv.columnCount + 1];
+    int count = selectCSVColumns(&csv, columns);
+    
+    allocateMemory_propertyBased();
+    copyCSVInvariantNames(&csv, columns);
+    
+    double *values[count];
+    values[0] = (double *)malloc(sizeof(double) * objectCount * count);
+    if(values[0] == NULL){
+        fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+    for(j = 1; j < count; j++){
+        values[j] = values[0] + (size_t)objectCount * j;
+    }
+    readCSVColumns(&csv, columns, count, values);
+    closeCSVFile(&csv);
+    
+    for(j = 0; j < invariantCount; j++){
+        for(i = 0; i < objectCount; i++){
+            if(!convertPropertyValue(values[j][i], invariantValues_propertyBased[i] + j)){
+                fprintf(stderr, "Error while reading CSV file: row %d, column %s is not a property value -- exiting!\n",
+                        i + 1, invariantNames[j]);
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    if(count > invariantCount){
+        for(i = 0; i < objectCount; i++){
+            if(!convertPropertyValue(values[invariantCount][i], knownTheory_propertyBased + i)){
+                BAILOUT("Error while reading known theory")
+            }
+        }
+    }
+    free(values[0]);
+    
+    partitionObjects_propertyBased();
 }
 
 boolean checkKnownTheory(){
@@ -1759,15 +3509,15 @@ boolean checkKnownTheory(){
     int i;
     int hitCount = 0;
     for(i=0; i<objectCount; i++){
-        if(isnan(invariantValues[i][mainInvariant])){
+        if(isnan(invariantValues[mainInvariant][i])){
             continue; //skip NaN
         }
         if(isnan(knownTheory[i])){
             continue; //skip NaN
         }
-        if(!handleComparator(invariantValues[i][mainInvariant], knownTheory[i], inequality)){
+        if(!handleComparator(invariantValues[mainInvariant][i], knownTheory[i], inequality)){
             return FALSE;
-        } else if(invariantValues[i][mainInvariant] == knownTheory[i]){
+        } else if(invariantValues[mainInvariant][i] == knownTheory[i]){
             hitCount++;
         }
     }
@@ -1816,12 +3566,12 @@ void printInvariantValues(FILE *f){
     fprintf(f, "\n");
     //table
     for(i=0; i<objectCount; i++){
-        fprintf(f, "%3d) ", i+1);
+        fprintf(f, "%3d) ", OBJECT_NUMBER(i));
         if(theoryProvided){
             fprintf(f, "%11.6lf   ", knownTheory[i]);
         }
         for(j=0; j<invariantCount; j++){
-            fprintf(f, "%11.6lf   ", invariantValues[i][j]);
+            fprintf(f, "%11.6lf   ", invariantValues[j][i]);
         }
         fprintf(f, "\n");
     }
@@ -1840,7 +3590,7 @@ void printInvariantValues_propertyBased(FILE *f){
     fprintf(f, "\n");
     //table
     for(i=0; i<objectCount; i++){
-        fprintf(f, "%3d) ", i+1);
+        fprintf(f, "%3d) ", objectNumbers[i]);
         if(theoryProvided){
             if(knownTheory_propertyBased[i] == UNDEFINED){
                 fprintf(f, " UNDEFINED    ");
@@ -1950,7 +3700,12 @@ void help(char *name){
     fprintf(stderr, "    --dalmatian\n");
     fprintf(stderr, "       Use the dalmatian heuristic to make conjectures.\n");
     fprintf(stderr, "    --grinvin\n");
-    fprintf(stderr, "       Use the heuristic from Grinvin to make conjectures.\n");
+    fprintf(stderr, "       Use the heuristic from Grinvin to make conjectures. The objects for\n");
+    fprintf(stderr, "       which the main invariant is undefined are not used for the value error.\n");
+    fprintf(stderr, "    --grinvin-keep n\n");
+    fprintf(stderr, "       Keep the n expressions with the smallest value error when using the\n");
+    fprintf(stderr, "       heuristic from Grinvin. These are output in order of increasing value\n");
+    fprintf(stderr, "       error. The default is 1.\n");
     fprintf(stderr, "\n");
     fprintf(stderr, "\e[1m* Various options\e[21m\n");
     fprintf(stderr, "    -h, --help\n");
@@ -1971,10 +3726,104 @@ void help(char *name){
     fprintf(stderr, "       stdin.\n");
     fprintf(stderr, "    --invariants filename\n");
     fprintf(stderr, "       Specifies the file containing the invariant values. Defaults to stdin.\n");
+    fprintf(stderr, "    --invariants-shm name\n");
+    fprintf(stderr, "       Read the invariant values in the binary format from the POSIX shared\n");
+    fprintf(stderr, "       memory object with the given name (e.g., /conjecturing). The object is\n");
+    fprintf(stderr, "       mapped into memory and is not changed.\n");
+    fprintf(stderr, "    --csv filename\n");
+    fprintf(stderr, "       Read the invariant values from a CSV file instead. The first line of\n");
+    fprintf(stderr, "       the file should contain the column names, which are used as invariant\n");
+    fprintf(stderr, "       names. Empty fields and NA are read as NaN (or as undefined for property\n");
+    fprintf(stderr, "       based conjectures). By default all columns are used and the first column\n");
+    fprintf(stderr, "       is the main invariant. Columns can be specified by their name or by\n");
+    fprintf(stderr, "       their number.\n");
+    fprintf(stderr, "    --main-column column\n");
+    fprintf(stderr, "       The column of the CSV file which contains the main invariant.\n");
+    fprintf(stderr, "    --include-columns column,column,...\n");
+    fprintf(stderr, "       Only use these columns of the CSV file (and the main invariant column).\n");
+    fprintf(stderr, "    --exclude-columns column,column,...\n");
+    fprintf(stderr, "       Do not use these columns of the CSV file.\n");
+    fprintf(stderr, "    --theory-column column\n");
+    fprintf(stderr, "       The column of the CSV file which contains the known theory. This column\n");
+    fprintf(stderr, "       is never used as an invariant.\n");
+    fprintf(stderr, "    --threads n\n");
+    fprintf(stderr, "       The number of threads that are used to read a CSV file and to evaluate\n");
+    fprintf(stderr, "       conjectures (see \e[4m--evaluate\e[24m). The default is 1.\n");
+    fprintf(stderr, "    --main-invariant n\n");
+    fprintf(stderr, "       Use invariant n as main invariant instead of the one given in the input.\n");
+    fprintf(stderr, "    --targets invariant:comparator,...\n");
+    fprintf(stderr, "       Make conjectures for several targets in one run. Each target consists\n");
+    fprintf(stderr, "       of a main invariant (its number or its name) and a comparator (leq,\n");
+    fprintf(stderr, "       less, geq or greater), e.g., 3:leq,3:geq,5:leq. Each expression is\n");
+    fprintf(stderr, "       only generated and evaluated once and is then tested for each target.\n");
+    fprintf(stderr, "       The conjectures are written target by target. This is only supported\n");
+    fprintf(stderr, "       for the dalmatian heuristic and can not be used with known theory.\n");
+    fprintf(stderr, "    --stream file\n");
+    fprintf(stderr, "       Write an event to the given file (use - for standard output) each time\n");
+    fprintf(stderr, "       a conjecture is added to or removed from the conjectures kept by the\n");
+    fprintf(stderr, "       dalmatian heuristic. Each event is a JSON object on a single line, e.g.,\n");
+    fprintf(stderr, "       {\"event\":\"add\",\"slot\":0,\"main\":\"I1\",\"comparator\":\"<=\",\n");
+    fprintf(stderr, "       \"expression\":[\"I2\",\"I3\",\"+\"],\"complexity\":2,\"hits\":3,\"time\":0.01}.\n");
+    fprintf(stderr, "       The expression is given in post-order. A conjecture is identified by its\n");
+    fprintf(stderr, "       slot, main invariant and comparator. There are also events when the\n");
+    fprintf(stderr, "       complexity increases (level) and when the generation stops (done).\n");
+    fprintf(stderr, "       When the events are written to standard output, the conjectures are\n");
+    fprintf(stderr, "       written to standard error after the statistics.\n");
+    fprintf(stderr, "    --evaluate file\n");
+    fprintf(stderr, "       Evaluate the conjectures in the given file instead of generating\n");
+    fprintf(stderr, "       expressions. The conjectures should be in the stack output format (as\n");
+    fprintf(stderr, "       written with \e[4m-o s\e[24m) and are checked for all objects of the\n");
+    fprintf(stderr, "       invariants input. For each conjecture a line is written with the number\n");
+    fprintf(stderr, "       of objects for which it is false, the number of objects for which it is\n");
+    fprintf(stderr, "       tight, the number of objects for which it is undefined and the numbers\n");
+    fprintf(stderr, "       of the first (at most %d) objects for which it is false. The conjectures\n", MAX_REPORTED_VIOLATIONS);
+    fprintf(stderr, "       are evaluated in parallel when \e[4m--threads\e[24m is given.\n");
+    fprintf(stderr, "    --invariant-costs c1,c2,...\n");
+    fprintf(stderr, "       The cost of computing each invariant. The invariants are tried in order\n");
+    fprintf(stderr, "       of increasing cost, so expressions with cheap invariants are considered\n");
+    fprintf(stderr, "       first.\n");
+    fprintf(stderr, "    --demand-pipes requests,responses\n");
+    fprintf(stderr, "       Request deferred invariant values only when an expression needs them. In\n");
+    fprintf(stderr, "       a binary invariants file a value is deferred by giving it as the NaN with\n");
+    fprintf(stderr, "       bit pattern 0x%llx. Each request is written to the file\n", DEFERRED_VALUE_BITS);
+    fprintf(stderr, "       requests as a line with the (zero-based) number of the invariant, the\n");
+    fprintf(stderr, "       number of values and the (zero-based) numbers of the objects. The values\n");
+    fprintf(stderr, "       should then be written to the file responses as doubles in native byte\n");
+    fprintf(stderr, "       order. The objects that rejected the most expressions are evaluated\n");
+    fprintf(stderr, "       first. Without this option deferred values are treated as unknown.\n");
+    fprintf(stderr, "    --collapse-duplicates\n");
+    fprintf(stderr, "       Evaluate objects with identical invariant values (and known theory)\n");
+    fprintf(stderr, "       only once. The skips are counted with the number of identical objects,\n");
+    fprintf(stderr, "       so the results do not change.\n");
+    fprintf(stderr, "    --prune-invariants\n");
+    fprintf(stderr, "       Do not use invariants that are constant or that are a duplicate, a\n");
+    fprintf(stderr, "       negation or another affine transform (e.g., x + 1) of an earlier\n");
+    fprintf(stderr, "       invariant or of the main invariant. These invariants can only lead to\n");
+    fprintf(stderr, "       redundant conjectures. The pruned invariants are reported.\n");
+    fprintf(stderr, "    --cache-mb n\n");
+    fprintf(stderr, "       Keep the values of small subexpressions that are used often in a cache\n");
+    fprintf(stderr, "       of at most n megabytes, so they are not evaluated again in larger\n");
+    fprintf(stderr, "       expressions. The least recently used values are evicted first. The\n");
+    fprintf(stderr, "       default is 0, i.e., no cache is used.\n");
     fprintf(stderr, "    --print-valid-expressions\n");
     fprintf(stderr, "       Causes all valid expressions that are found to be printed to stderr.\n");
     fprintf(stderr, "    --maximum-complexity\n");
     fprintf(stderr, "       Print the maximum complexity reached during the generation to stderr.\n");
+    fprintf(stderr, "\n");
+    fprintf(stderr, "\e[1m* Server\e[21m\n");
+    fprintf(stderr, "    --server path\n");
+    fprintf(stderr, "       Run as a server that listens on the Unix domain socket with the given\n");
+    fprintf(stderr, "       path. The datasets are read once when the server starts. Each client\n");
+    fprintf(stderr, "       sends one job: a line containing the name of a dataset followed by the\n");
+    fprintf(stderr, "       options for that job (e.g., -c --dalmatian --geq --main-invariant 2).\n");
+    fprintf(stderr, "       Unless --all-operators is given, the operators follow on the next lines.\n");
+    fprintf(stderr, "       The output of the job is sent back over the connection. Each job runs\n");
+    fprintf(stderr, "       in a separate process, so several jobs can run at the same time. The\n");
+    fprintf(stderr, "       options -p, -t and --invariant-names apply to all datasets and should be\n");
+    fprintf(stderr, "       given when the server is started.\n");
+    fprintf(stderr, "    --dataset name=filename\n");
+    fprintf(stderr, "       Load the invariants file (or CSV file if the name ends with .csv) as a\n");
+    fprintf(stderr, "       dataset with the given name. This option can be given several times.\n");
     fprintf(stderr, "\n\n");
     fprintf(stderr, "\e[1mInput format\n============\e[21m\n");
     fprintf(stderr, "The operators that should be used and the invariant values are read from an in-\n");
@@ -2028,6 +3877,22 @@ void help(char *name){
     fprintf(stderr, "   \e[22m\n");
     fprintf(stderr, "   The example above assumes you are using the option \e[4m--invariant-names\e[24m. If this\n");
     fprintf(stderr, "   is not the case, then you can skip the second until fifth line.\n");
+    fprintf(stderr, "\e[1m* Binary invariants\e[21m\n");
+    fprintf(stderr, "   The invariant values can also be given in a binary format which can be read\n");
+    fprintf(stderr, "   much faster. The format is detected automatically. A binary file starts with\n");
+    fprintf(stderr, "   the 8 bytes \"\\211EXPRINV\" followed by four 32-bit integers in native byte\n");
+    fprintf(stderr, "   order: the number of objects, the number of invariants, the number of the\n");
+    fprintf(stderr, "   main invariant and the flags (1: invariant names are given, 2: known theory\n");
+    fprintf(stderr, "   is given). Each invariant name is given as a 32-bit integer with the length\n");
+    fprintf(stderr, "   of the name followed by the characters of the name. The header is padded with\n");
+    fprintf(stderr, "   zeroes to a multiple of 8 bytes. Then the known theory follows (one double\n");
+    fprintf(stderr, "   per object) and finally the invariant values as doubles column by column:\n");
+    fprintf(stderr, "   1st value of 1st object, 1st value of 2nd object,..., 2nd value of 1st\n");
+    fprintf(stderr, "   object,... For property based conjectures the values should be 0, 1 or NaN.\n");
+    fprintf(stderr, "   These values can also be packed (flag 4): the known theory and each property\n");
+    fprintf(stderr, "   are then given by two bit vectors padded to a multiple of 64 bits. The first\n");
+    fprintf(stderr, "   one tells which values are defined and the second one which values are true.\n");
+    fprintf(stderr, "   Bit i is stored in byte i/8 at position i%%8.\n");
     fprintf(stderr, "\n\n");
     fprintf(stderr, "\e[1mHeuristics\n==========\e[21m\n");
     fprintf(stderr, "This program allows the heuristic used to select bounds to be altered. Currently\n");
@@ -2050,6 +3915,9 @@ void help(char *name){
     fprintf(stderr, "   the product of the number of objects in the considered database and two to\n");
     fprintf(stderr, "   the power number of unary plus twice the number of binary operators is less\n");
     fprintf(stderr, "   than the best value error up to that point.\n");
+    fprintf(stderr, "   The value error is accumulated while an expression is evaluated, and the\n");
+    fprintf(stderr, "   evaluation is stopped as soon as it is clear that the expression will not\n");
+    fprintf(stderr, "   be kept. Such expressions are not counted as valid expressions.\n");
     fprintf(stderr, "\n\n");
     fprintf(stderr, "Please mail  \e[4mnico [DOT] vancleemput [AT] gmail [DOT] com\e[24m in case of trouble.\n");
 }
@@ -2088,6 +3956,25 @@ int processOptions(int argc, char **argv) {
         {"sufficient", no_argument, NULL, 0},
         {"necessary", no_argument, NULL, 0},
         {"maximum-complexity", no_argument, NULL, 0},
+        {"grinvin-keep", required_argument, NULL, 0},
+        {"csv", required_argument, NULL, 0},
+        {"main-column", required_argument, NULL, 0},
+        {"include-columns", required_argument, NULL, 0},
+        {"exclude-columns", required_argument, NULL, 0},
+        {"theory-column", required_argument, NULL, 0},
+        {"threads", required_argument, NULL, 0},
+        {"server", required_argument, NULL, 0},
+        {"dataset", required_argument, NULL, 0},
+        {"main-invariant", required_argument, NULL, 0},
+        {"targets", required_argument, NULL, 0},
+        {"stream", required_argument, NULL, 0},
+        {"evaluate", required_argument, NULL, 0},
+        {"invariants-shm", required_argument, NULL, 0},
+        {"invariant-costs", required_argument, NULL, 0},
+        {"demand-pipes", required_argument, NULL, 0},
+        {"collapse-duplicates", no_argument, NULL, 0},
+        {"prune-invariants", no_argument, NULL, 0},
+        {"cache-mb", required_argument, NULL, 0},
         {"help", no_argument, NULL, 'h'},
         {"verbose", no_argument, NULL, 'v'},
         {"unlabeled", no_argument, NULL, 'u'},
@@ -2137,10 +4024,12 @@ int processOptions(int argc, char **argv) {
                             heuristicInit = dalmatianHeuristicInit_propertyBased;
                             heuristicStopConditionReached = dalmatianHeuristicStopConditionReached_propertyBased;
                             heuristicPostProcessing = dalmatianHeuristicPostProcessing_propertyBased;
+                            heuristicFree = dalmatianHeuristicFree_propertyBased;
                         } else {
                             heuristicInit = dalmatianHeuristicInit;
                             heuristicStopConditionReached = dalmatianHeuristicStopConditionReached;
                             heuristicPostProcessing = dalmatianHeuristicPostProcessing;
+                            heuristicFree = dalmatianHeuristicFree;
                         }
                         break;
                     case 8:
@@ -2148,6 +4037,7 @@ int processOptions(int argc, char **argv) {
                         heuristicInit = grinvinHeuristicInit;
                         heuristicStopConditionReached = grinvinHeuristicStopConditionReached;
                         heuristicPostProcessing = grinvinHeuristicPostProcessing;
+                        heuristicFree = grinvinHeuristicFree;
                         break;
                     case 9:
                         useInvariantNames = TRUE;
@@ -2191,6 +4081,131 @@ int processOptions(int argc, char **argv) {
                     case 21:
                         report_maximum_complexity_reached = TRUE;
                         break;
+                    case 22:
+                        grinvinExpressionCount = strtol(optarg, NULL, 10);
+                        if(grinvinExpressionCount <= 0){
+                            fprintf(stderr, "Illegal number of expressions for grinvin heuristic: %d.\n", grinvinExpressionCount);
+                            usage(name);
+                            return EXIT_FAILURE;
+                        }
+                        break;
+                    case 23:
+                        csvFilename = optarg;
+                        useInvariantNames = TRUE;
+                        break;
+                    case 24:
+                        csvMainColumn = optarg;
+                        break;
+                    case 25:
+                        csvIncludedColumns = optarg;
+                        break;
+                    case 26:
+                        csvExcludedColumns = optarg;
+                        break;
+                    case 27:
+                        csvTheoryColumn = optarg;
+                        break;
+                    case 28:
+                        threadCount = strtol(optarg, NULL, 10);
+                        if(threadCount <= 0){
+                            fprintf(stderr, "Illegal number of threads: %d.\n", threadCount);
+                            usage(name);
+                            return EXIT_FAILURE;
+                        }
+                        break;
+                    case 29:
+                        serverSocketPath = optarg;
+                        break;
+                    case 30:
+                        datasetSpecifications = (char **)realloc(datasetSpecifications,
+                                sizeof(char *) * (datasetCount + 1));
+                        if(datasetSpecifications == NULL){
+                            fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+                            exit(EXIT_FAILURE);
+                        }
+                        datasetSpecifications[datasetCount++] = optarg;
+                        break;
+                    case 31:
+                        selectedMainInvariant = strtol(optarg, NULL, 10) - 1;
+                        if(selectedMainInvariant < 0){
+                            fprintf(stderr, "Illegal main invariant: %s.\n", optarg);
+                            usage(name);
+                            return EXIT_FAILURE;
+                        }
+                        break;
+                    case 32:
+                        targetSpecification = optarg;
+                        break;
+                    case 33:
+                        if(strcmp(optarg, "-") == 0){
+                            streamFile = stdout;
+                            closeStreamFile = FALSE;
+                        } else {
+                            streamFile = fopen(optarg, "w");
+                            if(streamFile == NULL){
+                                fprintf(stderr, "Could not open %s for writing.\n", optarg);
+                                return EXIT_FAILURE;
+                            }
+                            closeStreamFile = TRUE;
+                        }
+                        break;
+                    case 34:
+                        evaluationFile = fopen(optarg, "r");
+                        if(evaluationFile == NULL){
+                            fprintf(stderr, "Could not open %s for reading.\n", optarg);
+                            return EXIT_FAILURE;
+                        }
+                        break;
+                    case 35: {
+                        int descriptor = shm_open(optarg, O_RDONLY, 0);
+                        if(descriptor == -1 ||
+                                (invariantsFile = fdopen(descriptor, "r")) == NULL){
+                            fprintf(stderr, "Could not open shared memory object %s for reading.\n", optarg);
+                            return EXIT_FAILURE;
+                        }
+                        closeInvariantsFile = TRUE;
+                        break;
+                    }
+                    case 36:
+                        invariantCostSpecification = optarg;
+                        break;
+                    case 37: {
+                        char *responses = strchr(optarg, ',');
+                        if(responses == NULL){
+                            fprintf(stderr, "Illegal demand pipes: %s.\n", optarg);
+                            usage(name);
+                            return EXIT_FAILURE;
+                        }
+                        *responses = '\0';
+                        responses++;
+                        demandRequestsFile = fopen(optarg, "w");
+                        if(demandRequestsFile == NULL){
+                            fprintf(stderr, "Could not open %s for writing.\n", optarg);
+                            return EXIT_FAILURE;
+                        }
+                        demandResponsesFile = fopen(responses, "r");
+                        if(demandResponsesFile == NULL){
+                            fprintf(stderr, "Could not open %s for reading.\n", responses);
+                            return EXIT_FAILURE;
+                        }
+                        break;
+                    }
+                    case 38:
+                        collapseDuplicates = TRUE;
+                        break;
+                    case 39:
+                        pruneRedundantInvariants = TRUE;
+                        break;
+                    case 40: {
+                        long megabytes = strtol(optarg, NULL, 10);
+                        if(megabytes < 0){
+                            fprintf(stderr, "Illegal cache size: %s.\n", optarg);
+                            usage(name);
+                            return EXIT_FAILURE;
+                        }
+                        valueCacheBudget = (unsigned long int)megabytes << 20;
+                        break;
+                    }
                     default:
                         fprintf(stderr, "Illegal option index %d.\n", option_index);
                         usage(name);
@@ -2262,187 +4277,2124 @@ int processOptions(int argc, char **argv) {
         }
     }
     
-    if(onlyLabeled + onlyUnlabeled +
-            generateExpressions + generateAllExpressions + doConjecturing != TRUE){
-        fprintf(stderr, "Please select one type to be generated.\n");
+    if(demandRequestsFile != NULL && (serverSocketPath != NULL || evaluationFile != NULL ||
+            propertyBased || targetSpecification != NULL)){
+        fprintf(stderr, "Deferred invariant values can only be requested when generating invariant-based\nexpressions or conjectures for a single target.\n");
         usage(name);
         return EXIT_FAILURE;
     }
     
-    if(doConjecturing && selectedHeuristic==NO_HEURISTIC){
-        fprintf(stderr, "Please select a heuristic to make conjectures.\n");
+    if(pruneRedundantInvariants && (propertyBased || demandRequestsFile != NULL)){
+        fprintf(stderr, "Invariants can only be pruned for invariant-based expressions without\ndeferred values.\n");
         usage(name);
         return EXIT_FAILURE;
     }
     
-    // check the non-option arguments
-    if ((onlyUnlabeled || generateExpressions) && argc - optind != 2) {
+    if(collapseDuplicates && (propertyBased || demandRequestsFile != NULL)){
+        fprintf(stderr, "Duplicate objects can only be collapsed for invariant-based expressions\nwithout deferred values.\n");
         usage(name);
         return EXIT_FAILURE;
     }
     
-    if (onlyLabeled && argc - optind != 3) {
-        usage(name);
-        return EXIT_FAILURE;
+    if(serverSocketPath != NULL){
+        if(datasetCount == 0){
+            fprintf(stderr, "Please specify at least one dataset for the server.\n");
+            usage(name);
+            return EXIT_FAILURE;
+        }
+        return -1;
     }
     
-    if (generateAllExpressions && (argc > optind + 3)) {
+    if(onlyLabeled + onlyUnlabeled + generateExpressions +
+            generateAllExpressions + doConjecturing + (evaluationFile != NULL) != TRUE){
+        fprintf(stderr, "Please select one type to be generated.\n");
         usage(name);
         return EXIT_FAILURE;
     }
     
-    if (doConjecturing && !((argc == optind) || (argc - optind == 2))) {
+    if(doConjecturing && selectedHeuristic==NO_HEURISTIC){
+        fprintf(stderr, "Please select a heuristic to make conjectures.\n");
         usage(name);
         return EXIT_FAILURE;
     }
     
-    // check comparator for property-based conjectures
-    if (propertyBased && 
-            !((inequality == SUFFICIENT) || (inequality == NECESSARY))){
-        fprintf(stderr, "For property-based conjectures you can only use --sufficient or --necessary.\n");
+    if(doConjecturing && selectedHeuristic==GRINVIN_HEURISTIC){
+        trackValueError = TRUE;
+    }
+    
+    if(targetSpecification != NULL){
+        if(!doConjecturing || propertyBased || selectedHeuristic!=DALMATIAN_HEURISTIC){
+            fprintf(stderr, "Multiple targets are only supported for invariant-based conjectures with the dalmatian heuristic.\n");
+            usage(name);
+            return EXIT_FAILURE;
+        }
+        if(theoryProvided){
+            fprintf(stderr, "Known theory can not be used in combination with multiple targets.\n");
+            usage(name);
+            return EXIT_FAILURE;
+        }
+        heuristicInit = dalmatianMultiTargetHeuristicInit;
+        heuristicStopConditionReached = dalmatianMultiTargetHeuristicStopConditionReached;
+        heuristicPostProcessing = dalmatianMultiTargetHeuristicPostProcessing;
+        heuristicFree = dalmatianMultiTargetHeuristicFree;
+    }
+    
+    if(streamFile != NULL && !(doConjecturing && selectedHeuristic==DALMATIAN_HEURISTIC)){
+        fprintf(stderr, "Streaming is only supported for conjectures with the dalmatian heuristic.\n");
         usage(name);
         return EXIT_FAILURE;
     }
     
+    //the events own standard output, so the conjectures go with the statistics
+    if(streamFile != NULL && streamFile == conjectureFile){
+        conjectureFile = statisticsFile;
+    }
     
-    return -1;
-}
-
-int main(int argc, char *argv[]) {
+    // check the non-option arguments
+    if ((onlyUnlabeled || generateExpressions) && argc - optind != 2) {
+        usage(name);
+        return EXIT_FAILURE;
+    }
     
-    operatorFile = stdin;
-    invariantsFile = stdin;
+    if (onlyLabeled && argc - optind != 3) {
+        usage(name);
+        return EXIT_FAILURE;
+    }
     
-    int po = processOptions(argc, argv);
-    if(po != -1) return po;
+    if (generateAllExpressions && (argc > optind + 3)) {
+        usage(name);
+        return EXIT_FAILURE;
+    }
+    
+    if (doConjecturing && !((argc == optind) || (argc - optind == 2))) {
+        usage(name);
+        return EXIT_FAILURE;
+    }
+    
+    // check comparator for property-based conjectures
+    if (propertyBased && 
+            !((inequality == SUFFICIENT) || (inequality == NECESSARY))){
+        fprintf(stderr, "For property-based conjectures you can only use --sufficient or --necessary.\n");
+        usage(name);
+        return EXIT_FAILURE;
+    }
     
-    int unary = 0;
-    int binary = 0;
+    
+    return -1;
+}
+
+void setAllOperators(){
+    int i;
+    for (i=0; i<unaryOperatorCount; i++) {
+        unaryOperators[i] = i;
+    }
+    for (i=0; i<commBinaryOperatorCount; i++) {
+        commBinaryOperators[i] = i;
+    }
+    for (i=0; i<nonCommBinaryOperatorCount; i++) {
+        nonCommBinaryOperators[i] = i;
+    }
+}
+
+/* Reads the number of unary and binary operators (and maybe the number of
+ * invariants) from the non-option arguments.
+ */
+void readSizeArguments(int argc, char *argv[], int *unary, int *binary){
+    *unary = 0;
+    *binary = 0;
     if(!(doConjecturing || generateAllExpressions)){
-        unary = strtol(argv[optind], NULL, 10);
-        binary = strtol(argv[optind+1], NULL, 10);
+        *unary = strtol(argv[optind], NULL, 10);
+        *binary = strtol(argv[optind+1], NULL, 10);
         if(onlyLabeled) {
             invariantCount = strtol(argv[optind+2], NULL, 10);
         }
     } else if(generateAllExpressions && (argc - optind == 1)) {
         invariantCount = strtol(argv[optind], NULL, 10);
     } else if(generateAllExpressions && (argc - optind == 3)) {
-        unary = strtol(argv[optind], NULL, 10);
-        binary = strtol(argv[optind+1], NULL, 10);
+        *unary = strtol(argv[optind], NULL, 10);
+        *binary = strtol(argv[optind+1], NULL, 10);
         invariantCount = strtol(argv[optind+2], NULL, 10);
     } else if(argc - optind == 2) {
-        unary = strtol(argv[optind], NULL, 10);
-        binary = strtol(argv[optind+1], NULL, 10);
+        *unary = strtol(argv[optind], NULL, 10);
+        *binary = strtol(argv[optind+1], NULL, 10);
     }
+}
 
-    //set the operator labels
-    if(onlyLabeled) {
-        int i;
-        for (i=0; i<unaryOperatorCount; i++) {
-            unaryOperators[i] = i;
+void readInvariants(){
+    if(propertyBased){
+        if(csvFilename != NULL){
+            readCSVValues_propertyBased();
+        } else {
+            readInvariantsValues_propertyBased();
         }
-        for (i=0; i<commBinaryOperatorCount; i++) {
-            commBinaryOperators[i] = i;
+    } else {
+        if(csvFilename != NULL){
+            readCSVValues();
+        } else {
+            readInvariantsValues();
         }
-        for (i=0; i<nonCommBinaryOperatorCount; i++) {
-            nonCommBinaryOperators[i] = i;
+    }
+}
+
+/* Reads the targets for multi-target conjecturing. The targets are given as a
+ * comma-separated list of an invariant (its number or its name) and a
+ * comparator separated by a colon, e.g., 3:leq,3:geq,5:less. Returns FALSE if
+ * the specification is illegal.
+ */
+boolean readTargets(){
+    int i;
+    char *specification = strdup(targetSpecification);
+    if(specification == NULL){
+        fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    targetCount = 1;
+    for(i = 0; specification[i]; i++){
+        if(specification[i] == ',') targetCount++;
+    }
+    dalmatianTargets = (DALMATIAN_TARGET *)malloc(sizeof(DALMATIAN_TARGET) * targetCount);
+    if(dalmatianTargets == NULL){
+        fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    char *savePointer;
+    char *target = strtok_r(specification, ",", &savePointer);
+    for(i = 0; i < targetCount; i++){
+        char *comparator = target == NULL ? NULL : strrchr(target, ':');
+        if(comparator == NULL){
+            fprintf(statisticsFile, "Illegal target specification: %s.\n", targetSpecification);
+            break;
         }
-        allocateMemory_onlyLabeled();
-    } else if (!onlyUnlabeled){
-        if(operatorFile==NULL){
-            int i;
-            for (i=0; i<unaryOperatorCount; i++) {
-                unaryOperators[i] = i;
-            }
-            for (i=0; i<commBinaryOperatorCount; i++) {
-                commBinaryOperators[i] = i;
-            }
-            for (i=0; i<nonCommBinaryOperatorCount; i++) {
-                nonCommBinaryOperators[i] = i;
+        *comparator = '\0';
+        comparator++;
+        
+        char *end;
+        int invariant = strtol(target, &end, 10) - 1;
+        if(*end != '\0' || end == target){
+            //not a number, so it should be the name of an invariant
+            invariant = UNDEFINED;
+            if(useInvariantNames){
+                int j;
+                for(j = 0; j < invariantCount; j++){
+                    if(strcmp(invariantNames[j], target) == 0){
+                        invariant = j;
+                        break;
+                    }
+                }
             }
-        } else {
-            readOperators();
         }
-        if(generateAllExpressions && invariantCount>0){
-            allocateMemory_onlyLabeled();
+        if(invariant < 0 || invariant >= invariantCount){
+            fprintf(statisticsFile, "Illegal invariant in target: %s.\n", target);
+            break;
+        }
+        dalmatianTargets[i].mainInvariant = invariant;
+        
+        if(strcmp(comparator, "leq") == 0){
+            dalmatianTargets[i].inequality = LEQ;
+        } else if(strcmp(comparator, "less") == 0){
+            dalmatianTargets[i].inequality = LESS;
+        } else if(strcmp(comparator, "geq") == 0){
+            dalmatianTargets[i].inequality = GEQ;
+        } else if(strcmp(comparator, "greater") == 0){
+            dalmatianTargets[i].inequality = GREATER;
         } else {
-            if(propertyBased){
-                readInvariantsValues_propertyBased();
-                if(verbose) printInvariantValues_propertyBased(stderr);
-                if(!checkKnownTheory_propertyBased()){
-                    BAILOUT("Known theory is not consistent with main invariant")
-                }
-            } else {
-                readInvariantsValues();
-                if(verbose) printInvariantValues(stderr);
-                if(!checkKnownTheory()){
-                    BAILOUT("Known theory is not consistent with main invariant")
-                }
-            }
+            fprintf(statisticsFile, "Illegal comparator in target: %s.\n", comparator);
+            break;
+        }
+        
+        if(dalmatianTargets[i].mainInvariant != dalmatianTargets[0].mainInvariant){
+            multipleMainInvariants = TRUE;
         }
+        
+        target = strtok_r(NULL, ",", &savePointer);
     }
     
-    if(closeOperatorFile){
-        fclose(operatorFile);
-    }
-    if(closeInvariantsFile){
-        fclose(invariantsFile);
+    free(specification);
+    if(i < targetCount){
+        free(dalmatianTargets);
+        targetCount = 0;
+        multipleMainInvariants = FALSE;
+        return FALSE;
     }
     
-    //do heuristic initialisation
-    if(heuristicInit!=NULL){
-        heuristicInit();
+    mainInvariant = dalmatianTargets[0].mainInvariant;
+    inequality = dalmatianTargets[0].inequality;
+    return TRUE;
+}
+
+/* Returns TRUE if the objects have the same value (bit for bit) for each
+ * invariant and for the known theory.
+ */
+boolean identicalObjects(int first, int second){
+    int j;
+    for(j = 0; j < invariantCount; j++){
+        if(memcmp(invariantValues[j] + first, invariantValues[j] + second, sizeof(double))){
+            return FALSE;
+        }
+    }
+    return !theoryProvided ||
+            !memcmp(knownTheory + first, knownTheory + second, sizeof(double));
+}
+
+uint64_t hashObject(int object){
+    int j;
+    uint64_t bits;
+    uint64_t hash = 14695981039346656037ULL; //FNV-1a
+    for(j = 0; j <= invariantCount; j++){
+        if(j < invariantCount){
+            memcpy(&bits, invariantValues[j] + object, sizeof(bits));
+        } else if(theoryProvided){
+            memcpy(&bits, knownTheory + object, sizeof(bits));
+        } else {
+            break;
+        }
+        hash = (hash ^ bits) * 1099511628211ULL;
+    }
+    return hash ^ (hash >> 29);
+}
+
+/* Replaces each group of identical objects by its first object, which gets
+ * the size of the group as multiplicity. The values of the remaining objects
+ * are copied, so the values that were read are not changed.
+ */
+void collapseDuplicateObjects(){
+    int i, j;
+    int tableSize = 1;
+    while(tableSize < 2 * objectCount) tableSize *= 2;
+    int *table = (int *)malloc(sizeof(int) * tableSize);
+    int *firstObject = (int *)malloc(sizeof(int) * objectCount);
+    int *multiplicity = (int *)malloc(sizeof(int) * objectCount);
+    if(table == NULL || firstObject == NULL || multiplicity == NULL){
+        fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+    for(i = 0; i < tableSize; i++){
+        table[i] = -1;
+    }
+    for(i = 0; i < objectCount; i++){
+        multiplicity[i] = 0;
     }
     
-    //register handlers for signals
-    signal(SIGALRM, handleAlarmSignal);
-    signal(SIGINT, handleInterruptSignal);
-    signal(SIGTERM, handleTerminationSignal);
-    
-    //if timeOut is non-zero: start alarm
-    if(timeOut) alarm(timeOut);
+    //the table contains the number of each group found so far
+    int uniqueCount = 0;
+    for(i = 0; i < objectCount; i++){
+        int position = hashObject(i) & (tableSize - 1);
+        while(table[position] != -1 && !identicalObjects(firstObject[table[position]], i)){
+            position = (position + 1) & (tableSize - 1);
+        }
+        if(table[position] == -1){
+            table[position] = uniqueCount;
+            firstObject[uniqueCount++] = i;
+        }
+        multiplicity[table[position]]++;
+    }
+    free(table);
     
-    //start actual generation process
-    if(doConjecturing || generateAllExpressions){
-        conjecture(unary, binary);
-    } else {
-        generateTree(unary, binary);
+    if(verbose){
+        fprintf(stderr, "Collapsed %d objects into %d distinct objects.\n", objectCount, uniqueCount);
+    }
+    if(uniqueCount == objectCount){
+        free(firstObject);
+        free(multiplicity);
+        return;
     }
     
-    //give information about the reason why the program halted
-    if(heuristicStoppedGeneration){
-        fprintf(stderr, "Generation process was stopped by the conjecturing heuristic.\n");
-    } else if(timeOutReached){
-        fprintf(stderr, "Generation process was stopped because the maximum time was reached.\n");
-    } else if(userInterrupted){
-        fprintf(stderr, "Generation process was interrupted by user.\n");
-    } else if(terminationSignalReceived){
-        fprintf(stderr, "Generation process was killed.\n");
+    collapsedValues = (double *)malloc(sizeof(double) * uniqueCount * invariantCount);
+    if(collapsedValues == NULL){
+        fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+    for(j = 0; j < invariantCount; j++){
+        for(i = 0; i < uniqueCount; i++){
+            collapsedValues[(size_t)uniqueCount * j + i] = invariantValues[j][firstObject[i]];
+        }
+        invariantValues[j] = collapsedValues + (size_t)uniqueCount * j;
+    }
+    if(theoryProvided){
+        collapsedTheory = (double *)malloc(sizeof(double) * uniqueCount);
+        if(collapsedTheory == NULL){
+            fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+            exit(EXIT_FAILURE);
+        }
+        for(i = 0; i < uniqueCount; i++){
+            collapsedTheory[i] = knownTheory[firstObject[i]];
+        }
+        knownTheory = collapsedTheory;
+    }
+    for(i = 0; i < uniqueCount; i++){
+        firstObject[i]++;
+    }
+    collapsedObjectNumbers = firstObject;
+    objectMultiplicity = multiplicity;
+    objectCount = uniqueCount;
+}
+
+/* Returns TRUE if the second invariant equals scale * first + offset for
+ * each object. The values should be undefined for the same objects.
+ */
+boolean affinelyRelated(int first, int second, double *scale, double *offset){
+    int i, defined = -1;
+    double *x = invariantValues[first];
+    double *y = invariantValues[second];
+    for(i = 0; i < objectCount; i++){
+        if(isnan(x[i]) != isnan(y[i])) return FALSE;
+        if(isnan(x[i])) continue;
+        if(defined == -1){
+            defined = i;
+        } else if(x[i] != x[defined]){
+            break;
+        }
+    }
+    if(i == objectCount){
+        return FALSE; //the first invariant is constant or undefined
+    }
+    *scale = (y[i] - y[defined]) / (x[i] - x[defined]);
+    *offset = y[defined] - *scale * x[defined];
+    if(*scale == 0.0 || !isfinite(*scale) || !isfinite(*offset)){
+        return FALSE;
+    }
+    for(i = 0; i < objectCount; i++){
+        if(isnan(x[i]) != isnan(y[i]) ||
+                (!isnan(x[i]) && (*scale) * x[i] + (*offset) != y[i])){
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/* Marks the invariants that can only lead to redundant expressions: the
+ * invariants that are constant and the invariants that are a duplicate, a
+ * negation or another affine transform of an earlier invariant or of a main
+ * invariant. The main invariants are never pruned.
+ */
+void pruneInvariants(){
+    int i, j, k;
+    free(invariantPruned);
+    free(prunedReference);
+    free(prunedScale);
+    free(prunedOffset);
+    invariantPruned = (boolean *)malloc(sizeof(boolean) * invariantCount);
+    prunedReference = (int *)malloc(sizeof(int) * invariantCount);
+    prunedScale = (double *)malloc(sizeof(double) * invariantCount);
+    prunedOffset = (double *)malloc(sizeof(double) * invariantCount);
+    if(invariantPruned == NULL || prunedReference == NULL ||
+            prunedScale == NULL || prunedOffset == NULL){
+        fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
     }
     
-    //print some statistics
-    if(onlyUnlabeled){
-        fprintf(stderr, "Found %lu unlabeled trees.\n", treeCount);
-    } else if(onlyLabeled) {
-        fprintf(stderr, "Found %lu unlabeled trees.\n", treeCount);
-        fprintf(stderr, "Found %lu labeled trees.\n", labeledTreeCount);
-    } else if(generateAllExpressions) {
-        fprintf(stderr, "Found %lu unlabeled trees.\n", treeCount);
-        fprintf(stderr, "Found %lu labeled trees.\n", labeledTreeCount);
-    } else if(generateExpressions || doConjecturing) {
-        fprintf(stderr, "Found %lu unlabeled trees.\n", treeCount);
-        fprintf(stderr, "Found %lu labeled trees.\n", labeledTreeCount);
-        fprintf(stderr, "Found %lu valid expressions.\n", validExpressionsCount);
+    //the main invariants are checked first, so they are used as reference
+    int order[invariantCount];
+    boolean isMain[invariantCount];
+    int count = 0;
+    for(j = 0; j < invariantCount; j++){
+        isMain[j] = j == mainInvariant;
+    }
+    for(k = 0; k < targetCount; k++){
+        isMain[dalmatianTargets[k].mainInvariant] = TRUE;
+    }
+    for(j = 0; j < invariantCount; j++){
+        if(isMain[j]) order[count++] = j;
+    }
+    for(j = 0; j < invariantCount; j++){
+        if(!isMain[j]) order[count++] = j;
     }
     
-    if(report_maximum_complexity_reached){
-        fprintf(stderr, "Maximum complexity reached was %d\n", maximum_complexity_reached);
+    prunedInvariantCount = 0;
+    for(k = 0; k < invariantCount; k++){
+        j = order[k];
+        invariantPruned[j] = FALSE;
+        if(isMain[j]) continue;
+        
+        boolean constant = TRUE;
+        for(i = 0; i < objectCount && constant; i++){
+            constant = !isnan(invariantValues[j][i]) &&
+                    invariantValues[j][i] == invariantValues[j][0];
+        }
+        if(constant){
+            invariantPruned[j] = TRUE;
+            prunedReference[j] = -1;
+        } else {
+            for(i = 0; i < k && !invariantPruned[j]; i++){
+                if(!invariantPruned[order[i]] &&
+                        affinelyRelated(order[i], j, prunedScale + j, prunedOffset + j)){
+                    invariantPruned[j] = TRUE;
+                    prunedReference[j] = order[i];
+                }
+            }
+        }
+        if(invariantPruned[j]){
+            prunedInvariantCount++;
+        }
+    }
+}
+
+void printInvariantName(int invariant, FILE *f){
+    if(useInvariantNames){
+        fprintf(f, "%s", invariantNames[invariant]);
+    } else {
+        fprintf(f, "I%d", invariant + 1);
+    }
+}
+
+void reportPrunedInvariants(FILE *f){
+    int j;
+    for(j = 0; j < invariantCount; j++){
+        if(!invariantPruned[j]) continue;
+        fprintf(f, "Invariant ");
+        printInvariantName(j, f);
+        if(prunedReference[j] == -1){
+            fprintf(f, " is not used: it is constant.\n");
+            continue;
+        }
+        fprintf(f, " is not used: it equals ");
+        if(prunedScale[j] == -1.0){
+            fprintf(f, "-");
+        } else if(prunedScale[j] != 1.0){
+            fprintf(f, "%g * ", prunedScale[j]);
+        }
+        printInvariantName(prunedReference[j], f);
+        if(prunedOffset[j] != 0.0){
+            fprintf(f, " %c %g", prunedOffset[j] < 0 ? '-' : '+', fabs(prunedOffset[j]));
+        }
+        fprintf(f, ".\n");
+    }
+}
+
+/* Builds the table with the values of each unary operator in use applied to
+ * each invariant that can appear at a leaf. The values are computed with
+ * handleUnaryOperator, so they are exactly the values that evaluateNode would
+ * compute.
+ */
+void buildUnaryLeafTable(){
+    int i, j, k;
+    free(unaryLeafColumns);
+    free(unaryLeafValues);
+    unaryLeafColumns = NULL;
+    unaryLeafValues = NULL;
+    if(!(generateExpressions || doConjecturing) || deferredValuesPresent ||
+            unaryOperatorCount == 0){
+        return;
     }
     
-    //do some heuristic-specific post-processing like outputting the conjectures
-    if(heuristicPostProcessing!=NULL){
-        heuristicPostProcessing();
+    int columnCount = 0;
+    boolean usable[invariantCount];
+    for(j = 0; j < invariantCount; j++){
+        usable[j] = (j != mainInvariant || allowMainInvariantInExpressions || multipleMainInvariants) &&
+                !(prunedInvariantCount > 0 && invariantPruned[j]);
+        if(usable[j]) columnCount++;
+    }
+    size_t size = sizeof(double) * objectCount * (size_t)columnCount * unaryOperatorCount;
+    if(columnCount == 0 || size > UNARY_LEAF_TABLE_LIMIT){
+        return;
     }
     
-    return 0;
+    unaryLeafColumns = (double **)malloc(sizeof(double *) * MAX_UNARY_OPERATORS * invariantCount);
+    unaryLeafValues = (double *)malloc(size);
+    if(unaryLeafColumns == NULL || unaryLeafValues == NULL){
+        fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+    for(i = 0; i < MAX_UNARY_OPERATORS * invariantCount; i++){
+        unaryLeafColumns[i] = NULL;
+    }
+    double *column = unaryLeafValues;
+    for(k = 0; k < unaryOperatorCount; k++){
+        int id = unaryOperators[k];
+        for(j = 0; j < invariantCount; j++){
+            if(!usable[j]) continue;
+            for(i = 0; i < objectCount; i++){
+                column[i] = handleUnaryOperator(id, invariantValues[j][i]);
+            }
+            unaryLeafColumns[id*invariantCount + j] = column;
+            column += objectCount;
+        }
+    }
+}
+
+/* Returns the number of objects in the given column for which the unary
+ * operator with the given ID is undefined (i.e., gives NaN), because the
+ * value is undefined or outside of the domain of the operator.
+ */
+int countUndefinedUnaryValues(int id, COLUMN_DOMAIN *domain){
+    if(id==7 || id==8 || id==9){ //sqrt, ln, log10
+        return domain->undefined + domain->negative;
+    } else if(id==18 || id==19 || id==26){ //asin, acos, atanh
+        return domain->undefined + domain->outsideUnitInterval;
+    } else if(id==25){ //acosh
+        return domain->undefined + domain->belowOne;
+    } else {
+        return domain->undefined;
+    }
+}
+
+/* Returns a bitset of the objects for which the given unary operator applied
+ * to the given invariant is undefined, or NULL if there are no such objects.
+ * An ID of -1 gives the bitset for the invariant itself.
+ */
+uint64_t *buildUndefinedMask(int id, int invariant){
+    int i;
+    uint64_t *mask = NULL;
+    for(i = 0; i < objectCount; i++){
+        double value = invariantValues[invariant][i];
+        if(id >= 0 && !isnan(value)){
+            value = handleUnaryOperator(id, value);
+        }
+        if(!isnan(value)) continue;
+        if(mask == NULL){
+            mask = (uint64_t *)calloc(maskWordCount, sizeof(uint64_t));
+            if(mask == NULL){
+                fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        mask[i >> 6] |= 1ULL << (i & 63);
+    }
+    return mask;
+}
+
+void freeUndefinedMasks(){
+    int i;
+    for(i = 0; i < undefinedMaskCount; i++){
+        free(undefinedMasks[i]);
+    }
+    free(undefinedMasks);
+    free(mainUndefinedMask);
+    free(subtreeMaskValues);
+    undefinedMasks = NULL;
+    undefinedMaskCount = 0;
+    mainUndefinedMask = NULL;
+    subtreeMaskValues = NULL;
+    undefinedMasksUsed = FALSE;
 }
+
+/* Builds the bitsets of undefined values for the leaves and for the unary
+ * operators in use applied to a leaf. They are only used if at least one of
+ * them is not empty.
+ */
+void buildUndefinedMasks(){
+    int j, k;
+    freeUndefinedMasks();
+    maskWordCount = (objectCount + 63) / 64;
+    undefinedMaskCount = (MAX_UNARY_OPERATORS + 1) * invariantCount;
+    undefinedMasks = (uint64_t **)malloc(sizeof(uint64_t *) * undefinedMaskCount);
+    if(undefinedMasks == NULL){
+        fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+    leafUndefinedMasks = undefinedMasks;
+    unaryLeafUndefinedMasks = undefinedMasks + invariantCount;
+    for(j = 0; j < undefinedMaskCount; j++){
+        undefinedMasks[j] = NULL;
+    }
+    for(j = 0; j < invariantCount; j++){
+        leafUndefinedMasks[j] = buildUndefinedMask(-1, j);
+        if(leafUndefinedMasks[j] != NULL){
+            undefinedMasksUsed = TRUE;
+        }
+        for(k = 0; k < unaryOperatorCount; k++){
+            int id = unaryOperators[k];
+            unaryLeafUndefinedMasks[id*invariantCount + j] = buildUndefinedMask(id, j);
+            if(unaryLeafUndefinedMasks[id*invariantCount + j] != NULL){
+                undefinedMasksUsed = TRUE;
+            }
+        }
+    }
+    if(targetCount == 0){
+        mainUndefinedMask = buildUndefinedMask(-1, mainInvariant);
+    }
+    if(undefinedMasksUsed){
+        subtreeMaskValues = (uint64_t *)malloc(sizeof(uint64_t) * (MAX_NODES_USED) * maskWordCount);
+        if(subtreeMaskValues == NULL){
+            fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+/* Determines the domain of the values of each invariant and uses this to
+ * decide which leaves and which unary operators applied to a leaf leave too
+ * many objects undefined. Only the objects that are not skipped anyway because
+ * the main invariant is undefined are taken into account. With several
+ * targets there is no single main invariant, and the number of skips for each
+ * target is at least the number of objects for which the expression is
+ * undefined.
+ */
+void prepareOperatorDomains(){
+    int i, j, k;
+    free(leafExceedsSkips);
+    free(unaryLeafExceedsSkips);
+    leafExceedsSkips = NULL;
+    unaryLeafExceedsSkips = NULL;
+    skippedLabelingCount = 0;
+    freeUndefinedMasks();
+    skipUndefinedLabelings = doConjecturing && !printValidExpressions && !deferredValuesPresent &&
+            (selectedHeuristic==DALMATIAN_HEURISTIC || selectedHeuristic==GRINVIN_HEURISTIC);
+    if(!skipUndefinedLabelings) return;
+    
+    nanAbsorbingOperators = FALSE;
+    for(i = 0; i < commBinaryOperatorCount; i++){
+        if(commBinaryOperators[i] == 2 || commBinaryOperators[i] == 3){
+            nanAbsorbingOperators = TRUE;
+        }
+    }
+    for(i = 0; i < nonCommBinaryOperatorCount; i++){
+        if(nonCommBinaryOperators[i] == 2){
+            nanAbsorbingOperators = TRUE;
+        }
+    }
+    
+    leafExceedsSkips = (boolean *)malloc(sizeof(boolean) * invariantCount);
+    unaryLeafExceedsSkips = (boolean *)malloc(sizeof(boolean) * MAX_UNARY_OPERATORS * invariantCount);
+    if(leafExceedsSkips == NULL || unaryLeafExceedsSkips == NULL){
+        fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    mainSkipCount = 0;
+    if(targetCount == 0){
+        for(i = 0; i < objectCount; i++){
+            if(isnan(invariantValues[mainInvariant][i])){
+                mainSkipCount += OBJECT_WEIGHT(i);
+            }
+        }
+    }
+    for(j = 0; j < invariantCount; j++){
+        COLUMN_DOMAIN domain = {0, 0, 0, 0};
+        for(i = 0; i < objectCount; i++){
+            if(targetCount == 0 && isnan(invariantValues[mainInvariant][i])){
+                continue;
+            }
+            double value = invariantValues[j][i];
+            if(isnan(value)){
+                domain.undefined += OBJECT_WEIGHT(i);
+                continue;
+            }
+            if(value < 0){
+                domain.negative += OBJECT_WEIGHT(i);
+            }
+            if(value < 1){
+                domain.belowOne += OBJECT_WEIGHT(i);
+            }
+            if(value < -1 || value > 1){
+                domain.outsideUnitInterval += OBJECT_WEIGHT(i);
+            }
+        }
+        leafExceedsSkips[j] = tooManyUndefinedValues(domain.undefined, mainSkipCount);
+        for(k = 0; k < MAX_UNARY_OPERATORS; k++){
+            unaryLeafExceedsSkips[k*invariantCount + j] =
+                    tooManyUndefinedValues(countUndefinedUnaryValues(k, &domain), mainSkipCount);
+        }
+    }
+    
+    buildUndefinedMasks();
+}
+
+/* Selects the main invariant if it was given as an option and checks the
+ * known theory.
+ */
+boolean prepareInvariants(){
+    if(selectedMainInvariant != UNDEFINED){
+        if(selectedMainInvariant < 0 || selectedMainInvariant >= invariantCount){
+            fprintf(statisticsFile, "Illegal main invariant: %d.\n", selectedMainInvariant + 1);
+            return FALSE;
+        }
+        mainInvariant = selectedMainInvariant;
+    }
+    if(targetSpecification != NULL && !readTargets()){
+        return FALSE;
+    }
+    if(propertyBased){
+        //the partition depends on the main invariant and the inequality, which
+        //might have changed since the objects were read (e.g., in server mode)
+        partitionObjects_propertyBased();
+        if(verbose) printInvariantValues_propertyBased(stderr);
+        if(!checkKnownTheory_propertyBased()){
+            fprintf(statisticsFile, "Known theory is not consistent with main invariant.\n");
+            return FALSE;
+        }
+    } else {
+        if(verbose) printInvariantValues(stderr);
+        if(!checkKnownTheory()){
+            fprintf(statisticsFile, "Known theory is not consistent with main invariant.\n");
+            return FALSE;
+        }
+        if(demandRequestsFile != NULL && !prepareDeferredValues()){
+            return FALSE;
+        }
+        //the values of a previous run might have been collapsed
+        free(objectMultiplicity);
+        free(collapsedValues);
+        free(collapsedTheory);
+        free(collapsedObjectNumbers);
+        objectMultiplicity = NULL;
+        collapsedValues = NULL;
+        collapsedTheory = NULL;
+        collapsedObjectNumbers = NULL;
+        weightedObjectCount = objectCount;
+        if(collapseDuplicates){
+            collapseDuplicateObjects();
+        }
+        prunedInvariantCount = 0;
+        if(pruneRedundantInvariants){
+            pruneInvariants();
+        }
+        buildUnaryLeafTable();
+        prepareOperatorDomains();
+        initValueCache();
+    }
+    return TRUE;
+}
+
+/* Determines the order in which the invariants are tried at the leaves. If
+ * costs are given, then the cheapest invariants are tried first, so that the
+ * expressions which need expensive invariants are only reached later. Ties
+ * are broken by the number of the invariant. Returns FALSE if the costs can
+ * not be read.
+ */
+boolean orderInvariants(){
+    int i, j;
+    double costs[invariantCount > 0 ? invariantCount : 1];
+    free(invariantOrder);
+    invariantOrder = (int *)malloc(sizeof(int) * (invariantCount > 0 ? invariantCount : 1));
+    if(invariantOrder == NULL){
+        fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+    for(i = 0; i < invariantCount; i++){
+        invariantOrder[i] = i;
+        costs[i] = 0.0;
+    }
+    if(invariantCostSpecification == NULL) return TRUE;
+    
+    char *position = invariantCostSpecification;
+    for(i = 0; i < invariantCount; i++){
+        char *end;
+        costs[i] = strtod(position, &end);
+        if(end == position || (*end != ',' && *end != '\0') ||
+                (*end == '\0' && i < invariantCount - 1) ||
+                (*end == ',' && i == invariantCount - 1)){
+            fprintf(statisticsFile, "Error while reading invariant costs.\n");
+            return FALSE;
+        }
+        position = end + 1;
+    }
+    //insertion sort keeps invariants with the same cost in their order
+    for(i = 1; i < invariantCount; i++){
+        int invariant = invariantOrder[i];
+        for(j = i; j > 0 && costs[invariantOrder[j-1]] > costs[invariant]; j--){
+            invariantOrder[j] = invariantOrder[j-1];
+        }
+        invariantOrder[j] = invariant;
+    }
+    return TRUE;
+}
+
+/* Runs the generation process and reports the results. The input should
+ * already have been read.
+ */
+int runGeneration(int unary, int binary){
+    if(!orderInvariants()){
+        return EXIT_FAILURE;
+    }
+    
+    //do heuristic initialisation
+    if(heuristicInit!=NULL){
+        heuristicInit();
+    }
+    if(generateExpressions || doConjecturing){
+        allocateCandidateValues();
+    }
+    if(prunedInvariantCount > 0){
+        reportPrunedInvariants(statisticsFile);
+    }
+    updateHeuristicStopCondition();
+    
+    //register handlers for signals
+    void (*previousAlarmHandler)(int) = signal(SIGALRM, handleAlarmSignal);
+    void (*previousInterruptHandler)(int) = signal(SIGINT, handleInterruptSignal);
+    void (*previousTerminationHandler)(int) = signal(SIGTERM, handleTerminationSignal);
+    
+    //if timeOut is non-zero: start alarm
+    if(timeOut) alarm(timeOut);
+    
+    if(streamFile != NULL){
+        startStream();
+    }
+    
+    //start actual generation process
+    if(doConjecturing || generateAllExpressions){
+        conjecture(unary, binary);
+    } else {
+        generateTree(unary, binary);
+    }
+    
+    //restore the previous handlers (this matters when used as a library)
+    if(timeOut) alarm(0);
+    signal(SIGALRM, previousAlarmHandler);
+    signal(SIGINT, previousInterruptHandler);
+    signal(SIGTERM, previousTerminationHandler);
+    
+    //no more values will be requested, so the caller can stop answering
+    if(demandRequestsFile != NULL){
+        fclose(demandRequestsFile);
+        fclose(demandResponsesFile);
+    }
+    
+    //give information about the reason why the program halted
+    if(heuristicStoppedGeneration){
+        fprintf(statisticsFile, "Generation process was stopped by the conjecturing heuristic.\n");
+        streamDoneEvent("heuristic");
+    } else if(timeOutReached){
+        fprintf(statisticsFile, "Generation process was stopped because the maximum time was reached.\n");
+        streamDoneEvent("time");
+    } else if(userInterrupted){
+        fprintf(statisticsFile, "Generation process was interrupted by user.\n");
+        streamDoneEvent("interrupted");
+    } else if(terminationSignalReceived){
+        fprintf(statisticsFile, "Generation process was killed.\n");
+        streamDoneEvent("killed");
+    } else {
+        streamDoneEvent("finished");
+    }
+    
+    //print some statistics
+    if(onlyUnlabeled){
+        fprintf(statisticsFile, "Found %lu unlabeled trees.\n", treeCount);
+    } else if(onlyLabeled) {
+        fprintf(statisticsFile, "Found %lu unlabeled trees.\n", treeCount);
+        fprintf(statisticsFile, "Found %lu labeled trees.\n", labeledTreeCount);
+    } else if(generateAllExpressions) {
+        fprintf(statisticsFile, "Found %lu unlabeled trees.\n", treeCount);
+        fprintf(statisticsFile, "Found %lu labeled trees.\n", labeledTreeCount);
+    } else if(generateExpressions || doConjecturing) {
+        fprintf(statisticsFile, "Found %lu unlabeled trees.\n", treeCount);
+        fprintf(statisticsFile, "Found %lu labeled trees.\n", labeledTreeCount);
+        fprintf(statisticsFile, "Found %lu valid expressions.\n", validExpressionsCount);
+    }
+    
+    if(skippedLabelingCount > 0){
+        fprintf(statisticsFile, "Skipped %lu labeling%s that would leave too many objects undefined.\n",
+                skippedLabelingCount, skippedLabelingCount==1 ? "" : "s");
+    }
+    
+    if(valueCacheActive){
+        fprintf(statisticsFile, "Value cache: %lu hit%s, %lu miss%s, %lu vector%s stored, %lu evicted.\n",
+                valueCacheHits, valueCacheHits==1 ? "" : "s",
+                valueCacheMisses, valueCacheMisses==1 ? "" : "es",
+                valueCacheStored, valueCacheStored==1 ? "" : "s",
+                valueCacheEvictions);
+    }
+    
+    if(deferredValuesPresent){
+        fprintf(statisticsFile, "Requested %lu deferred invariant value%s in %lu request%s.\n",
+                demandedValuesCount, demandedValuesCount==1 ? "" : "s",
+                demandRequestCount, demandRequestCount==1 ? "" : "s");
+    }
+    
+    if(report_maximum_complexity_reached){
+        fprintf(statisticsFile, "Maximum complexity reached was %d\n", maximum_complexity_reached);
+    }
+    
+    //do some heuristic-specific post-processing like outputting the conjectures
+    if(heuristicPostProcessing!=NULL){
+        heuristicPostProcessing();
+    }
+    
+    if(closeStreamFile){
+        fclose(streamFile);
+    }
+    
+    return 0;
+}
+
+//------------------ Evaluation --------------------
+
+/* In evaluation mode a set of conjectures in the stack output format is read
+ * and each conjecture is evaluated for all objects. The objects are split into
+ * blocks and each combination of a conjecture and a block is a separate job,
+ * so the jobs can be handled by several threads. Within a job the conjecture
+ * is evaluated operator by operator for all objects in the block.
+ */
+#define EVALUATION_BLOCK_SIZE 1024
+
+typedef struct evaluationresult {
+    int violations;
+    int hits;
+    int undefined;
+    
+    //the smallest numbers of objects for which the conjecture is false
+    int firstViolations[MAX_REPORTED_VIOLATIONS];
+    int firstViolationCount;
+} EVALUATION_RESULT;
+
+typedef struct conjecture {
+    int mainInvariant;
+    int inequality;
+    
+    int length;
+    int (*labels)[2]; //the labels of the nodes in post-order
+    int stackSize;
+    
+    EVALUATION_RESULT result;
+} CONJECTURE;
+
+CONJECTURE *conjectures;
+int conjectureCount = 0;
+
+int evaluationBlockCount;
+EVALUATION_RESULT *evaluationBlockResults; //one for each job
+int nextEvaluationJob = 0;
+pthread_mutex_t evaluationJobMutex = PTHREAD_MUTEX_INITIALIZER;
+
+void printNodeLabel(int type, int id, char *buffer, size_t size){
+    NODE node;
+    node.contentLabel[0] = type;
+    node.contentLabel[1] = id;
+    FILE *f = fmemopen(buffer, size, "w");
+    if(f == NULL){
+        BAILOUT("Error while printing operator")
+    }
+    if(propertyBased){
+        printSingleNode_propertyBased(&node, f, NULL);
+    } else {
+        printSingleNode(&node, f, NULL);
+    }
+    fclose(f);
+}
+
+int findConjectureInvariant(char *token){
+    int i;
+    if(useInvariantNames){
+        for(i = 0; i < invariantCount; i++){
+            if(strcmp(invariantNames[i], token) == 0){
+                return i;
+            }
+        }
+    }
+    char *end;
+    if(token[0] == 'I'){
+        i = strtol(token + 1, &end, 10) - 1;
+        if(*end == '\0' && end != token + 1 && i >= 0 && i < invariantCount){
+            return i;
+        }
+    }
+    return UNDEFINED;
+}
+
+/* Translates a token of the stack format to the label of a node. Returns FALSE
+ * if the token is unknown.
+ */
+boolean findConjectureLabel(char *token, int *label){
+    int i, type;
+    char buffer[64];
+    int invariant = findConjectureInvariant(token);
+    if(invariant != UNDEFINED){
+        label[0] = INVARIANT_LABEL;
+        label[1] = invariant;
+        return TRUE;
+    }
+    int counts[] = {0, unaryOperatorCount, commBinaryOperatorCount, nonCommBinaryOperatorCount};
+    for(type = UNARY_LABEL; type <= NON_COMM_BINARY_LABEL; type++){
+        for(i = 0; i < counts[type]; i++){
+            printNodeLabel(type, i, buffer, sizeof(buffer));
+            if(strcmp(buffer, token) == 0){
+                label[0] = type;
+                label[1] = i;
+                return TRUE;
+            }
+        }
+    }
+    return FALSE;
+}
+
+int findConjectureComparator(char *token){
+    int i;
+    char buffer[64];
+    for(i = LEQ; i <= GREATER; i++){
+        if(propertyBased && i != SUFFICIENT && i != NECESSARY) continue;
+        FILE *f = fmemopen(buffer, sizeof(buffer), "w");
+        if(f == NULL){
+            BAILOUT("Error while printing comparator")
+        }
+        if(propertyBased){
+            printComparator_propertyBased(i, f);
+        } else {
+            printComparator(i, f);
+        }
+        fclose(f);
+        if(strcmp(buffer, token) == 0){
+            return i;
+        }
+    }
+    return UNDEFINED;
+}
+
+/* Stores the conjecture that consists of the given tokens: the main invariant,
+ * the expression in post-order and the comparator.
+ */
+void addConjecture(char **tokens, int tokenCount){
+    int i;
+    if(tokenCount < 3){
+        fprintf(stderr, "Conjecture %d is incomplete -- exiting!\n", conjectureCount + 1);
+        exit(EXIT_FAILURE);
+    }
+    conjectures = (CONJECTURE *)realloc(conjectures, sizeof(CONJECTURE) * (conjectureCount + 1));
+    if(conjectures == NULL){
+        fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+    CONJECTURE *conjecture = conjectures + conjectureCount;
+    conjectureCount++;
+    
+    conjecture->mainInvariant = findConjectureInvariant(tokens[0]);
+    if(conjecture->mainInvariant == UNDEFINED){
+        fprintf(stderr, "Unknown main invariant %s in conjecture %d -- exiting!\n", tokens[0], conjectureCount);
+        exit(EXIT_FAILURE);
+    }
+    conjecture->inequality = findConjectureComparator(tokens[tokenCount - 1]);
+    if(conjecture->inequality == UNDEFINED){
+        fprintf(stderr, "Unknown comparator %s in conjecture %d -- exiting!\n", tokens[tokenCount - 1], conjectureCount);
+        exit(EXIT_FAILURE);
+    }
+    
+    conjecture->length = tokenCount - 2;
+    conjecture->labels = malloc(sizeof(int[2]) * conjecture->length);
+    if(conjecture->labels == NULL){
+        fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+    int depth = 0;
+    conjecture->stackSize = 0;
+    for(i = 0; i < conjecture->length; i++){
+        int *label = conjecture->labels[i];
+        if(!findConjectureLabel(tokens[i + 1], label)){
+            fprintf(stderr, "Unknown token %s in conjecture %d -- exiting!\n", tokens[i + 1], conjectureCount);
+            exit(EXIT_FAILURE);
+        }
+        if(label[0] == INVARIANT_LABEL){
+            depth++;
+        } else if(label[0] != UNARY_LABEL){
+            depth--;
+        }
+        if(depth < 1){
+            fprintf(stderr, "Conjecture %d is not a valid expression -- exiting!\n", conjectureCount);
+            exit(EXIT_FAILURE);
+        }
+        if(depth > conjecture->stackSize){
+            conjecture->stackSize = depth;
+        }
+    }
+    if(depth != 1){
+        fprintf(stderr, "Conjecture %d is not a valid expression -- exiting!\n", conjectureCount);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/* Reads the conjectures in the stack format: each conjecture consists of the
+ * main invariant, the nodes of the expression in post-order and the comparator,
+ * each on a separate line. The conjectures are separated by empty lines.
+ */
+void readConjectures(){
+    char line[1024];
+    char **tokens = NULL;
+    int tokenCount = 0;
+    int tokensSize = 0;
+    boolean atEnd = FALSE;
+    while(!atEnd){
+        atEnd = !fgets(line, sizeof(line), evaluationFile);
+        if(!atEnd){
+            line[strcspn(line, "\r\n")] = '\0';
+        }
+        if(atEnd || line[0] == '\0'){
+            if(tokenCount > 0){
+                addConjecture(tokens, tokenCount);
+                int i;
+                for(i = 0; i < tokenCount; i++){
+                    free(tokens[i]);
+                }
+                tokenCount = 0;
+            }
+            continue;
+        }
+        if(tokenCount == tokensSize){
+            tokensSize = 2*tokensSize + 16;
+            tokens = (char **)realloc(tokens, sizeof(char *) * tokensSize);
+            if(tokens == NULL){
+                fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        tokens[tokenCount] = strdup(line);
+        if(tokens[tokenCount] == NULL){
+            fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+            exit(EXIT_FAILURE);
+        }
+        tokenCount++;
+    }
+    free(tokens);
+}
+
+/* Inserts the object number in the sorted list of the smallest object numbers
+ * of violations.
+ */
+void addViolation(EVALUATION_RESULT *result, int objectNumber){
+    int position = result->firstViolationCount;
+    if(position == MAX_REPORTED_VIOLATIONS){
+        if(result->firstViolations[position - 1] < objectNumber) return;
+        position--;
+    } else {
+        result->firstViolationCount++;
+    }
+    while(position > 0 && result->firstViolations[position - 1] > objectNumber){
+        result->firstViolations[position] = result->firstViolations[position - 1];
+        position--;
+    }
+    result->firstViolations[position] = objectNumber;
+}
+
+void evaluateConjectureBlock(CONJECTURE *conjecture, int start, int end,
+        EVALUATION_RESULT *result, double *stack){
+    int i, j;
+    int size = end - start;
+    double *top = stack - EVALUATION_BLOCK_SIZE; //the topmost value on the stack
+    for(j = 0; j < conjecture->length; j++){
+        int type = conjecture->labels[j][0];
+        int id = conjecture->labels[j][1];
+        if(type == INVARIANT_LABEL){
+            top += EVALUATION_BLOCK_SIZE;
+            memcpy(top, invariantValues[id] + start, sizeof(double) * size);
+        } else if(type == UNARY_LABEL){
+            for(i = 0; i < size; i++){
+                top[i] = handleUnaryOperator(id, top[i]);
+            }
+        } else {
+            double *left = top - EVALUATION_BLOCK_SIZE;
+            if(type == COMM_BINARY_LABEL){
+                for(i = 0; i < size; i++){
+                    left[i] = handleCommutativeBinaryOperator(id, left[i], top[i]);
+                }
+            } else {
+                for(i = 0; i < size; i++){
+                    left[i] = handleNonCommutativeBinaryOperator(id, left[i], top[i]);
+                }
+            }
+            top = left;
+        }
+    }
+    
+    double *mainValues = invariantValues[conjecture->mainInvariant] + start;
+    for(i = 0; i < size; i++){
+        if(isnan(mainValues[i]) || isnan(top[i])){
+            result->undefined++;
+        } else if(!handleComparator(mainValues[i], top[i], conjecture->inequality)){
+            result->violations++;
+            addViolation(result, start + i + 1);
+        } else if(mainValues[i] == top[i]){
+            result->hits++;
+        }
+    }
+}
+
+void evaluateConjectureBlock_propertyBased(CONJECTURE *conjecture, int start, int end,
+        EVALUATION_RESULT *result, boolean *stack){
+    int i, j;
+    int size = end - start;
+    boolean *top = stack - EVALUATION_BLOCK_SIZE; //the topmost value on the stack
+    for(j = 0; j < conjecture->length; j++){
+        int type = conjecture->labels[j][0];
+        int id = conjecture->labels[j][1];
+        if(type == INVARIANT_LABEL){
+            top += EVALUATION_BLOCK_SIZE;
+            for(i = 0; i < size; i++){
+                top[i] = invariantValues_propertyBased[start + i][id];
+            }
+        } else if(type == UNARY_LABEL){
+            for(i = 0; i < size; i++){
+                top[i] = handleUnaryOperator_propertyBased(id, top[i]);
+            }
+        } else {
+            boolean *left = top - EVALUATION_BLOCK_SIZE;
+            if(type == COMM_BINARY_LABEL){
+                for(i = 0; i < size; i++){
+                    left[i] = handleCommutativeBinaryOperator_propertyBased(id, left[i], top[i]);
+                }
+            } else {
+                for(i = 0; i < size; i++){
+                    left[i] = handleNonCommutativeBinaryOperator_propertyBased(id, left[i], top[i]);
+                }
+            }
+            top = left;
+        }
+    }
+    
+    for(i = 0; i < size; i++){
+        boolean mainValue = invariantValues_propertyBased[start + i][conjecture->mainInvariant];
+        if(mainValue == UNDEFINED || top[i] == UNDEFINED){
+            result->undefined++;
+        } else if(!handleComparator_propertyBased(mainValue, top[i], conjecture->inequality)){
+            result->violations++;
+            addViolation(result, objectNumbers[start + i]);
+        } else if(!(mainValue) == !(top[i])){
+            result->hits++;
+        }
+    }
+}
+
+void *evaluateConjecturesThread(void *stack){
+    while(TRUE){
+        pthread_mutex_lock(&evaluationJobMutex);
+        int job = nextEvaluationJob++;
+        pthread_mutex_unlock(&evaluationJobMutex);
+        if(job >= conjectureCount * evaluationBlockCount){
+            return NULL;
+        }
+        
+        CONJECTURE *conjecture = conjectures + job / evaluationBlockCount;
+        int start = (job % evaluationBlockCount) * EVALUATION_BLOCK_SIZE;
+        int end = start + EVALUATION_BLOCK_SIZE;
+        if(end > objectCount) end = objectCount;
+        EVALUATION_RESULT *result = evaluationBlockResults + job;
+        memset(result, 0, sizeof(EVALUATION_RESULT));
+        if(propertyBased){
+            evaluateConjectureBlock_propertyBased(conjecture, start, end, result, stack);
+        } else {
+            evaluateConjectureBlock(conjecture, start, end, result, stack);
+        }
+    }
+}
+
+void outputEvaluationResults(FILE *f){
+    int i, j;
+    fprintf(f, "conjecture\tviolations\thits\tundefined\tfirst violations\n");
+    for(i = 0; i < conjectureCount; i++){
+        EVALUATION_RESULT *result = &(conjectures[i].result);
+        fprintf(f, "%d\t%d\t%d\t%d\t", i + 1,
+                result->violations, result->hits, result->undefined);
+        for(j = 0; j < result->firstViolationCount; j++){
+            fprintf(f, j ? ",%d" : "%d", result->firstViolations[j]);
+        }
+        fprintf(f, "\n");
+    }
+}
+
+int runEvaluation(){
+    int i, j, k;
+    readConjectures();
+    if(conjectureCount == 0){
+        fprintf(stderr, "No conjectures to evaluate.\n");
+        return EXIT_FAILURE;
+    }
+    
+    evaluationBlockCount = (objectCount + EVALUATION_BLOCK_SIZE - 1) / EVALUATION_BLOCK_SIZE;
+    evaluationBlockResults = (EVALUATION_RESULT *)malloc(
+            sizeof(EVALUATION_RESULT) * conjectureCount * evaluationBlockCount);
+    if(evaluationBlockResults == NULL){
+        fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    //each thread needs a stack that is large enough for every conjecture
+    int stackSize = 0;
+    for(i = 0; i < conjectureCount; i++){
+        if(conjectures[i].stackSize > stackSize){
+            stackSize = conjectures[i].stackSize;
+        }
+    }
+    size_t valueSize = propertyBased ? sizeof(boolean) : sizeof(double);
+    void *stacks = malloc(valueSize * stackSize * EVALUATION_BLOCK_SIZE * threadCount);
+    if(stacks == NULL){
+        fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    //the calling thread also handles jobs
+    pthread_t threads[threadCount];
+    boolean threadStarted[threadCount];
+    for(i = 1; i < threadCount; i++){
+        threadStarted[i] = !pthread_create(threads + i, NULL, evaluateConjecturesThread,
+                (char *)stacks + i * valueSize * stackSize * EVALUATION_BLOCK_SIZE);
+    }
+    evaluateConjecturesThread(stacks);
+    for(i = 1; i < threadCount; i++){
+        if(threadStarted[i]){
+            pthread_join(threads[i], NULL);
+        }
+    }
+    
+    //combine the results of the blocks
+    for(i = 0; i < conjectureCount; i++){
+        EVALUATION_RESULT *result = &(conjectures[i].result);
+        memset(result, 0, sizeof(EVALUATION_RESULT));
+        for(j = 0; j < evaluationBlockCount; j++){
+            EVALUATION_RESULT *blockResult = evaluationBlockResults + i * evaluationBlockCount + j;
+            result->violations += blockResult->violations;
+            result->hits += blockResult->hits;
+            result->undefined += blockResult->undefined;
+            for(k = 0; k < blockResult->firstViolationCount; k++){
+                addViolation(result, blockResult->firstViolations[k]);
+            }
+        }
+    }
+    
+    outputEvaluationResults(stdout);
+    fprintf(stderr, "Evaluated %d conjecture%s for %d object%s.\n",
+            conjectureCount, conjectureCount == 1 ? "" : "s",
+            objectCount, objectCount == 1 ? "" : "s");
+    
+    for(i = 0; i < conjectureCount; i++){
+        free(conjectures[i].labels);
+    }
+    free(conjectures);
+    free(evaluationBlockResults);
+    free(stacks);
+    
+    return 0;
+}
+
+//------------------ Server --------------------
+
+/* In server mode the datasets are read once and stored. Each job runs in a
+ * separate process which is forked from the server, so the datasets are
+ * shared between all jobs and the jobs can run concurrently.
+ */
+typedef struct dataset {
+    char *name;
+    
+    int objectCount;
+    int invariantCount;
+    int mainInvariant;
+    
+    double **invariantValues;
+    double *knownTheory;
+    boolean **invariantValues_propertyBased;
+    boolean *knownTheory_propertyBased;
+    int *objectNumbers;
+    
+    char **invariantNames;
+    char **invariantNamesPointers;
+    boolean *invariantsUsed;
+} DATASET;
+
+DATASET *datasets;
+
+void storeDataset(DATASET *dataset, char *name){
+    dataset->name = name;
+    dataset->objectCount = objectCount;
+    dataset->invariantCount = invariantCount;
+    dataset->mainInvariant = mainInvariant;
+    dataset->invariantValues = invariantValues;
+    dataset->knownTheory = knownTheory;
+    dataset->invariantValues_propertyBased = invariantValues_propertyBased;
+    dataset->knownTheory_propertyBased = knownTheory_propertyBased;
+    dataset->objectNumbers = objectNumbers;
+    dataset->invariantNames = invariantNames;
+    dataset->invariantNamesPointers = invariantNamesPointers;
+    dataset->invariantsUsed = invariantsUsed;
+}
+
+void restoreDataset(DATASET *dataset){
+    objectCount = dataset->objectCount;
+    invariantCount = dataset->invariantCount;
+    mainInvariant = dataset->mainInvariant;
+    invariantValues = dataset->invariantValues;
+    knownTheory = dataset->knownTheory;
+    invariantValues_propertyBased = dataset->invariantValues_propertyBased;
+    knownTheory_propertyBased = dataset->knownTheory_propertyBased;
+    objectNumbers = dataset->objectNumbers;
+    invariantNames = dataset->invariantNames;
+    invariantNamesPointers = dataset->invariantNamesPointers;
+    invariantsUsed = dataset->invariantsUsed;
+}
+
+void loadDatasets(){
+    int i;
+    datasets = (DATASET *)malloc(sizeof(DATASET) * datasetCount);
+    if(datasets == NULL){
+        fprintf(stderr, "Initialisation failed: insufficient memory -- exiting!\n");
+        exit(EXIT_FAILURE);
+    }
+    for(i = 0; i < datasetCount; i++){
+        char *name = datasetSpecifications[i];
+        char *filename = strchr(name, '=');
+        if(filename == NULL){
+            fprintf(stderr, "Illegal dataset: %s -- exiting!\n", name);
+            exit(EXIT_FAILURE);
+        }
+        *filename = '\0';
+        filename++;
+        
+        size_t length = strlen(filename);
+        if(length > 4 && !strcmp(filename + length - 4, ".csv")){
+            csvFilename = filename;
+        } else {
+            csvFilename = NULL;
+            invariantsFile = fopen(filename, "r");
+            if(invariantsFile == NULL){
+                fprintf(stderr, "Could not open dataset %s -- exiting!\n", filename);
+                exit(EXIT_FAILURE);
+            }
+        }
+        readInvariants();
+        if(csvFilename == NULL){
+            fclose(invariantsFile);
+        }
+        storeDataset(datasets + i, name);
+        if(verbose){
+            fprintf(stderr, "Loaded dataset %s: %d objects, %d invariants.\n",
+                    name, objectCount, invariantCount);
+        }
+    }
+}
+
+/* Resets all options to their defaults. This is used by jobs of the server
+ * and by the library, which both process options more than once.
+ */
+void resetOptions(){
+    verbose = FALSE;
+    outputType = 'h';
+    allowMainInvariantInExpressions = FALSE;
+    useInvariantNames = FALSE;
+    allowedPercentageOfSkips = 0.2f;
+    inequality = LEQ;
+    unaryOperatorCount = 27;
+    commBinaryOperatorCount = 4;
+    nonCommBinaryOperatorCount = 3;
+    report_maximum_complexity_reached = FALSE;
+    timeOut = 0;
+    onlyUnlabeled = FALSE;
+    onlyLabeled = FALSE;
+    generateExpressions = FALSE;
+    generateAllExpressions = FALSE;
+    doConjecturing = FALSE;
+    propertyBased = FALSE;
+    theoryProvided = FALSE;
+    printValidExpressions = FALSE;
+    trackValueError = FALSE;
+    operatorFile = NULL;
+    invariantsFile = NULL;
+    csvFilename = NULL;
+    threadCount = 1;
+    selectedMainInvariant = UNDEFINED;
+    targetSpecification = NULL;
+    streamFile = NULL;
+    closeStreamFile = FALSE;
+    evaluationFile = NULL;
+    invariantCostSpecification = NULL;
+    demandRequestsFile = NULL;
+    collapseDuplicates = FALSE;
+    pruneRedundantInvariants = FALSE;
+    valueCacheBudget = 0;
+    serverSocketPath = NULL;
+    selectedHeuristic = NO_HEURISTIC;
+    heuristicStopConditionReached = NULL;
+    heuristicInit = NULL;
+    heuristicPostProcessing = NULL;
+    heuristicFree = NULL;
+    grinvinExpressionCount = 1;
+}
+
+/* Handles a single job. This function is executed in the forked process and
+ * never returns.
+ * 
+ * The first line that is sent by the client contains the name of the dataset
+ * followed by the options for this job, e.g.,
+ *   graphs -c --dalmatian --leq --time 5 --main-invariant 3 --all-operators
+ * If the option --all-operators is not given, then the operators follow on
+ * the next lines. The output is written to the connection.
+ */
+void handleServerJob(int connection){
+    int i;
+    char line[4096];
+    char *arguments[MAX_SERVER_JOB_ARGUMENTS];
+    int argumentCount = 0;
+    
+    FILE *connectionFile = fdopen(connection, "r");
+    if(connectionFile == NULL || fgets(line, sizeof(line), connectionFile) == NULL){
+        exit(EXIT_FAILURE);
+    }
+    
+    //the output of the job is sent to the client
+    dup2(connection, STDOUT_FILENO);
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    
+    arguments[argumentCount++] = "expressions";
+    char *argument = strtok(line, " \t\r\n");
+    while(argument != NULL && argumentCount < MAX_SERVER_JOB_ARGUMENTS){
+        arguments[argumentCount++] = argument;
+        argument = strtok(NULL, " \t\r\n");
+    }
+    if(argumentCount == 1){
+        fprintf(stderr, "Empty job -- ignoring!\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    DATASET *dataset = NULL;
+    for(i = 0; i < datasetCount; i++){
+        if(!strcmp(datasets[i].name, arguments[1])){
+            dataset = datasets + i;
+        }
+    }
+    if(dataset == NULL){
+        fprintf(stderr, "Unknown dataset %s -- ignoring job!\n", arguments[1]);
+        exit(EXIT_FAILURE);
+    }
+    
+    //the options of the server do not carry over to the job, except for
+    //those that determined how the datasets were read
+    boolean datasetPropertyBased = propertyBased;
+    boolean datasetTheoryProvided = theoryProvided;
+    boolean datasetInvariantNames = useInvariantNames;
+    resetOptions();
+    propertyBased = datasetPropertyBased;
+    useInvariantNames = datasetInvariantNames;
+    
+    //the dataset name takes the place of the program name
+    operatorFile = connectionFile;
+    closeOperatorFile = FALSE;
+    optind = 0;
+    int po = processOptions(argumentCount - 1, arguments + 1);
+    if(po != -1){
+        exit(po);
+    }
+    if(propertyBased != datasetPropertyBased){
+        fprintf(stderr, "Job does not match the type of dataset %s -- ignoring!\n", dataset->name);
+        exit(EXIT_FAILURE);
+    }
+    if(theoryProvided && !datasetTheoryProvided){
+        fprintf(stderr, "Dataset %s was loaded without known theory -- ignoring job!\n", dataset->name);
+        exit(EXIT_FAILURE);
+    }
+    if(useInvariantNames && !datasetInvariantNames){
+        fprintf(stderr, "Dataset %s was loaded without invariant names -- ignoring job!\n", dataset->name);
+        exit(EXIT_FAILURE);
+    }
+    if(!doConjecturing){
+        fprintf(stderr, "Only conjecturing jobs are supported in server mode -- ignoring!\n");
+        exit(EXIT_FAILURE);
+    }
+    
+    int unary, binary;
+    readSizeArguments(argumentCount - 1, arguments + 1, &unary, &binary);
+    
+    if(operatorFile == NULL){
+        setAllOperators();
+    } else {
+        readOperators();
+    }
+    
+    restoreDataset(dataset);
+    if(!prepareInvariants()){
+        exit(EXIT_FAILURE);
+    }
+    
+    exit(runGeneration(unary, binary));
+}
+
+int runServer(){
+    struct sockaddr_un address;
+    
+    loadDatasets();
+    
+    int serverSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(serverSocket < 0){
+        perror("Could not create socket");
+        return EXIT_FAILURE;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(strlen(serverSocketPath) >= sizeof(address.sun_path)){
+        fprintf(stderr, "Socket path is too long -- exiting!\n");
+        return EXIT_FAILURE;
+    }
+    strcpy(address.sun_path, serverSocketPath);
+    unlink(serverSocketPath);
+    if(bind(serverSocket, (struct sockaddr *)&address, sizeof(address)) < 0 ||
+            listen(serverSocket, 16) < 0){
+        perror("Could not listen on socket");
+        return EXIT_FAILURE;
+    }
+    
+    //finished jobs are reaped automatically
+    signal(SIGCHLD, SIG_IGN);
+    
+    //the server stops when it is interrupted or killed
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handleInterruptSignal;
+    sigaction(SIGINT, &action, NULL);
+    action.sa_handler = handleTerminationSignal;
+    sigaction(SIGTERM, &action, NULL);
+    
+    if(verbose){
+        fprintf(stderr, "Server is listening on %s.\n", serverSocketPath);
+    }
+    
+    while(!generationTerminated){
+        int connection = accept(serverSocket, NULL, NULL);
+        if(connection < 0){
+            continue; //interrupted by a signal
+        }
+        pid_t pid = fork();
+        if(pid == 0){
+            close(serverSocket);
+            signal(SIGCHLD, SIG_DFL);
+            signal(SIGINT, SIG_DFL);
+            signal(SIGTERM, SIG_DFL);
+            handleServerJob(connection);
+        } else if(pid < 0){
+            perror("Could not start job");
+        }
+        close(connection);
+    }
+    
+    close(serverSocket);
+    unlink(serverSocketPath);
+    return 0;
+}
+
+//------------------ Library --------------------
+
+#ifdef EXPRESSIONS_LIBRARY
+
+#include "libexpressions.h"
+
+/* When this file is compiled as a library, the functions below replace the
+ * main function. The generation still uses the global variables, so only one
+ * context can run at a time. Before each run the options and the state of the
+ * generation are reset to their defaults.
+ */
+struct expressionscontext {
+    int objectCount;
+    int invariantCount;
+    int mainInvariant;
+    const double *values;
+    const double *theory;
+    char **names;
+    
+    char *options;
+    
+    boolean allOperators;
+    int unaryOperators[MAX_UNARY_OPERATORS];
+    int unaryOperatorCount;
+    int commBinaryOperators[MAX_COMM_BINARY_OPERATORS];
+    int commBinaryOperatorCount;
+    int nonCommBinaryOperators[MAX_NCOMM_BINARY_OPERATORS];
+    int nonCommBinaryOperatorCount;
+    
+    char *results;
+    size_t resultsSize;
+    char **resultPointers;
+    int resultCount;
+    
+    char *messages;
+    size_t messagesSize;
+};
+
+void resetGenerationState(){
+    treeCount = 0;
+    labeledTreeCount = 0;
+    validExpressionsCount = 0;
+    maximum_complexity_reached = -1;
+    timeOutReached = FALSE;
+    userInterrupted = FALSE;
+    terminationSignalReceived = FALSE;
+    heuristicStoppedGeneration = FALSE;
+    generationTerminated = FALSE;
+    dalmatianFirst = TRUE;
+    dalmatianHitCount = 0;
+    grinvinBestError = DBL_MAX;
+    grinvinStoredExpressions = 0;
+    grinvinErrorBound = DBL_MAX;
+    deferredValuesPresent = FALSE;
+    demandRequestCount = 0;
+    demandedValuesCount = 0;
+}
+
+EXPRESSIONS_CONTEXT *expressionsCreateContext(){
+    EXPRESSIONS_CONTEXT *context = (EXPRESSIONS_CONTEXT *)calloc(1, sizeof(EXPRESSIONS_CONTEXT));
+    if(context != NULL){
+        context->allOperators = TRUE;
+    }
+    return context;
+}
+
+void expressionsClearResults(EXPRESSIONS_CONTEXT *context){
+    free(context->results);
+    free(context->resultPointers);
+    free(context->messages);
+    context->results = NULL;
+    context->resultsSize = 0;
+    context->resultPointers = NULL;
+    context->resultCount = 0;
+    context->messages = NULL;
+    context->messagesSize = 0;
+}
+
+void expressionsFreeNames(EXPRESSIONS_CONTEXT *context){
+    int i;
+    if(context->names != NULL){
+        for(i = 0; i < context->invariantCount; i++){
+            free(context->names[i]);
+        }
+        free(context->names);
+        context->names = NULL;
+    }
+}
+
+void expressionsFreeContext(EXPRESSIONS_CONTEXT *context){
+    if(context == NULL) return;
+    expressionsClearResults(context);
+    expressionsFreeNames(context);
+    free(context->options);
+    free(context);
+}
+
+int expressionsSetDataset(EXPRESSIONS_CONTEXT *context, int objectCount,
+        int invariantCount, int mainInvariant, const double *values,
+        const double *theory, const char * const *names){
+    int i;
+    if(objectCount <= 0 || invariantCount <= 0 || values == NULL ||
+            mainInvariant < 0 || mainInvariant >= invariantCount){
+        return -1;
+    }
+    expressionsFreeNames(context);
+    if(names != NULL){
+        context->names = (char **)calloc(invariantCount, sizeof(char *));
+        if(context->names == NULL){
+            return -1;
+        }
+        for(i = 0; i < invariantCount; i++){
+            context->names[i] = strdup(names[i]);
+            if(context->names[i] == NULL || strlen(names[i]) >= 1024){
+                context->invariantCount = i + 1;
+                expressionsFreeNames(context);
+                return -1;
+            }
+        }
+    }
+    context->objectCount = objectCount;
+    context->invariantCount = invariantCount;
+    context->mainInvariant = mainInvariant;
+    context->values = values;
+    context->theory = theory;
+    return 0;
+}
+
+int expressionsSetOperators(EXPRESSIONS_CONTEXT *context,
+        const int *unary, int unaryCount,
+        const int *commutative, int commutativeCount,
+        const int *nonCommutative, int nonCommutativeCount){
+    if(unaryCount < 0 || unaryCount > MAX_UNARY_OPERATORS ||
+            commutativeCount < 0 || commutativeCount > MAX_COMM_BINARY_OPERATORS ||
+            nonCommutativeCount < 0 || nonCommutativeCount > MAX_NCOMM_BINARY_OPERATORS){
+        return -1;
+    }
+    memcpy(context->unaryOperators, unary, sizeof(int) * unaryCount);
+    context->unaryOperatorCount = unaryCount;
+    memcpy(context->commBinaryOperators, commutative, sizeof(int) * commutativeCount);
+    context->commBinaryOperatorCount = commutativeCount;
+    memcpy(context->nonCommBinaryOperators, nonCommutative, sizeof(int) * nonCommutativeCount);
+    context->nonCommBinaryOperatorCount = nonCommutativeCount;
+    context->allOperators = FALSE;
+    return 0;
+}
+
+void expressionsUseAllOperators(EXPRESSIONS_CONTEXT *context){
+    context->allOperators = TRUE;
+}
+
+int expressionsSetOptions(EXPRESSIONS_CONTEXT *context, const char *options){
+    char *copy = strdup(options == NULL ? "" : options);
+    if(copy == NULL){
+        return -1;
+    }
+    free(context->options);
+    context->options = copy;
+    return 0;
+}
+
+/* Copies the dataset of the context to the global variables. The values of an
+ * invariant-based dataset are used without copying them.
+ */
+int loadContextDataset(EXPRESSIONS_CONTEXT *context){
+    int i, j;
+    objectCount = context->objectCount;
+    invariantCount = context->invariantCount;
+    mainInvariant = context->mainInvariant;
+    
+    if(propertyBased){
+        allocateMemory_propertyBased();
+        for(j = 0; j < invariantCount; j++){
+            for(i = 0; i < objectCount; i++){
+                if(!convertPropertyValue(context->values[(size_t)objectCount * j + i],
+                        invariantValues_propertyBased[i] + j)){
+                    return -1;
+                }
+            }
+        }
+        if(theoryProvided){
+            for(i = 0; i < objectCount; i++){
+                if(!convertPropertyValue(context->theory[i], knownTheory_propertyBased + i)){
+                    return -1;
+                }
+            }
+        }
+    } else {
+        allocateMemory_binaryInvariantBased();
+        for(j = 0; j < invariantCount; j++){
+            invariantValues[j] = (double *)context->values + (size_t)objectCount * j;
+        }
+        knownTheory = (double *)context->theory;
+    }
+    
+    if(useInvariantNames){
+        for(j = 0; j < invariantCount; j++){
+            strcpy(invariantNames[j], context->names[j]);
+            invariantNamesPointers[j] = invariantNames[j];
+        }
+    }
+    
+    if(propertyBased){
+        partitionObjects_propertyBased();
+    }
+    
+    return 0;
+}
+
+void freeContextDataset(){
+    int i;
+    if(propertyBased){
+        //the rows are partitioned: the block starts at the row of object 1
+        for(i = 0; i < objectCount; i++){
+            if(objectNumbers[i] == 1){
+                free(invariantValues_propertyBased[i]);
+            }
+        }
+        free(invariantValues_propertyBased);
+        free(knownTheory_propertyBased);
+        free(objectNumbers);
+    } else {
+        free(invariantValues);
+    }
+    free(invariantsUsed);
+    free(invariantNames[0]);
+    free(invariantNames);
+    free(invariantNamesPointers);
+}
+
+/* Splits the output in the stack format into the separate conjectures. */
+int splitContextResults(EXPRESSIONS_CONTEXT *context){
+    char *position = context->results;
+    int capacity = 0;
+    while(position != NULL && *position){
+        char *end = strstr(position, "\n\n");
+        if(end == NULL) break;
+        if(context->resultCount == capacity){
+            capacity = 2*capacity + 16;
+            char **pointers = (char **)realloc(context->resultPointers, sizeof(char *) * capacity);
+            if(pointers == NULL){
+                return -1;
+            }
+            context->resultPointers = pointers;
+        }
+        *end = '\0';
+        context->resultPointers[context->resultCount++] = position;
+        position = end + 2;
+    }
+    return 0;
+}
+
+/* Ends a run that failed: the message (if any) is added to the messages of
+ * the run and the results are discarded.
+ */
+int failRun(char *options, const char *message){
+    if(message != NULL){
+        fprintf(statisticsFile, "%s\n", message);
+    }
+    free(options);
+    fclose(conjectureFile);
+    fclose(statisticsFile);
+    conjectureFile = NULL;
+    statisticsFile = NULL;
+    return -1;
+}
+
+int expressionsRun(EXPRESSIONS_CONTEXT *context, unsigned long timeBudget){
+    int i;
+    if(context->values == NULL){
+        return -1;
+    }
+    expressionsClearResults(context);
+    
+    //the messages are also captured when the run fails
+    conjectureFile = open_memstream(&(context->results), &(context->resultsSize));
+    statisticsFile = open_memstream(&(context->messages), &(context->messagesSize));
+    if(conjectureFile == NULL || statisticsFile == NULL){
+        BAILOUT("Could not capture the output")
+    }
+    
+    //build the arguments from the options
+    char *options = strdup(context->options == NULL ? "" : context->options);
+    if(options == NULL){
+        return failRun(NULL, "Could not copy the options.");
+    }
+    char *arguments[MAX_SERVER_JOB_ARGUMENTS + 2];
+    int argumentCount = 0;
+    arguments[argumentCount++] = "expressions";
+    arguments[argumentCount++] = "-c";
+    char *savePointer;
+    char *argument = strtok_r(options, " \t\n", &savePointer);
+    while(argument != NULL && argumentCount < MAX_SERVER_JOB_ARGUMENTS + 1){
+        arguments[argumentCount++] = argument;
+        argument = strtok_r(NULL, " \t\n", &savePointer);
+    }
+    arguments[argumentCount] = NULL;
+    
+    //the options stay in use during the run (e.g., the targets)
+    resetOptions();
+    resetGenerationState();
+    optind = 0;
+    int result = processOptions(argumentCount, arguments);
+    if(result != -1 || optind != argumentCount){
+        fprintf(statisticsFile, "Illegal options: %s\n", context->options == NULL ? "" : context->options);
+        return failRun(options, NULL);
+    }
+    if(serverSocketPath != NULL || evaluationFile != NULL ||
+            csvFilename != NULL || invariantsFile != NULL || demandRequestsFile != NULL){
+        return failRun(options, "These options are not supported by the library.");
+    }
+    if(theoryProvided && context->theory == NULL){
+        return failRun(options, "Known theory was requested, but the dataset has none.");
+    }
+    useInvariantNames = context->names != NULL;
+    outputType = 's';
+    timeOut = timeBudget;
+    
+    //set the operators
+    if(context->allOperators){
+        setAllOperators();
+    } else {
+        unaryOperatorCount = context->unaryOperatorCount;
+        commBinaryOperatorCount = context->commBinaryOperatorCount;
+        nonCommBinaryOperatorCount = context->nonCommBinaryOperatorCount;
+        for(i = 0; i < unaryOperatorCount; i++){
+            unaryOperators[i] = context->unaryOperators[i];
+        }
+        for(i = 0; i < commBinaryOperatorCount; i++){
+            commBinaryOperators[i] = context->commBinaryOperators[i];
+        }
+        for(i = 0; i < nonCommBinaryOperatorCount; i++){
+            nonCommBinaryOperators[i] = context->nonCommBinaryOperators[i];
+        }
+    }
+    
+    if(loadContextDataset(context)){
+        freeContextDataset();
+        return failRun(options, "Could not load the dataset.");
+    }
+    if(!prepareInvariants()){
+        freeContextDataset();
+        return failRun(options, NULL);
+    }
+    
+    result = runGeneration(0, 0);
+    
+    if(result == EXIT_SUCCESS && heuristicFree != NULL){
+        heuristicFree();
+    }
+    freeCandidateValues();
+    freeContextDataset();
+    if(result != EXIT_SUCCESS){
+        return failRun(options, NULL);
+    }
+    free(options);
+    
+    fclose(conjectureFile);
+    fclose(statisticsFile);
+    conjectureFile = NULL;
+    statisticsFile = NULL;
+    
+    if(splitContextResults(context)){
+        return -1;
+    }
+    return context->resultCount;
+}
+
+int expressionsGetResultCount(EXPRESSIONS_CONTEXT *context){
+    return context->resultCount;
+}
+
+const char *expressionsGetResult(EXPRESSIONS_CONTEXT *context, int index){
+    if(index < 0 || index >= context->resultCount){
+        return NULL;
+    }
+    return context->resultPointers[index];
+}
+
+const char *expressionsGetMessages(EXPRESSIONS_CONTEXT *context){
+    return context->messages == NULL ? "" : context->messages;
+}
+
+#else
+
+int main(int argc, char *argv[]) {
+    
+    operatorFile = stdin;
+    invariantsFile = stdin;
+    conjectureFile = stdout;
+    statisticsFile = stderr;
+    
+    int po = processOptions(argc, argv);
+    if(po != -1) return po;
+    
+    if(serverSocketPath != NULL){
+        return runServer();
+    }
+    
+    if(evaluationFile != NULL){
+        readInvariants();
+        if(closeInvariantsFile){
+            fclose(invariantsFile);
+        }
+        int result = runEvaluation();
+        fclose(evaluationFile);
+        return result;
+    }
+    
+    int unary, binary;
+    readSizeArguments(argc, argv, &unary, &binary);
+
+    //set the operator labels
+    if(onlyLabeled) {
+        setAllOperators();
+        allocateMemory_onlyLabeled();
+    } else if (!onlyUnlabeled){
+        if(operatorFile==NULL){
+            setAllOperators();
+        } else {
+            readOperators();
+        }
+        if(generateAllExpressions && invariantCount>0){
+            allocateMemory_onlyLabeled();
+        } else {
+            readInvariants();
+            if(!prepareInvariants()){
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    
+    if(closeOperatorFile){
+        fclose(operatorFile);
+    }
+    if(closeInvariantsFile){
+        fclose(invariantsFile);
+    }
+    
+    return runGeneration(unary, binary);
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*
+ * Main developer: Nico Van Cleemput
+ * In collaboration with: Craig Larson
+ *
+ * Copyright (C) 2013 Ghent University.
+ * Licensed under the GNU GPL, read the file LICENSE.txt for details.
+ */
+
+#ifndef LIBEXPRESSIONS_H
+#define	LIBEXPRESSIONS_H
+
+/* C interface of the shared library libexpressions.
+ *
+ * A context holds a dataset, the operators and the options for a run. The
+ * values of the dataset are owned by the caller and are given column by
+ * column: values[j*objectCount + i] is the value of invariant j for object i.
+ * Missing values are given as NaN. For invariant-based conjectures the values
+ * are used without copying them, so they should remain valid during a run.
+ * For property-based conjectures (option -p) the values should be 0, 1 or NaN.
+ *
+ * The options are given as a string with the same options as the program
+ * expressions, e.g., "--dalmatian --leq --allowed-skips 0". The option -c is
+ * implied. The conjectures are returned in the stack output format, i.e., the
+ * main invariant, the expression in post-order and the comparator, each on a
+ * separate line.
+ *
+ * The conjecturing engine uses global state, so only one context can be run
+ * at a time and runs should not be made from several threads concurrently.
+ */
+
+typedef struct expressionscontext EXPRESSIONS_CONTEXT;
+
+EXPRESSIONS_CONTEXT *expressionsCreateContext();
+void expressionsFreeContext(EXPRESSIONS_CONTEXT *context);
+
+/* Returns 0 on success. The names may be NULL; the theory may be NULL if the
+ * option -t is not used. The main invariant is zero-based.
+ */
+int expressionsSetDataset(EXPRESSIONS_CONTEXT *context, int objectCount,
+        int invariantCount, int mainInvariant, const double *values,
+        const double *theory, const char * const *names);
+
+/* The operators are given by their numbers (see the option --example of
+ * expressions). By default all operators are used. Returns 0 on success.
+ */
+int expressionsSetOperators(EXPRESSIONS_CONTEXT *context,
+        const int *unary, int unaryCount,
+        const int *commutative, int commutativeCount,
+        const int *nonCommutative, int nonCommutativeCount);
+void expressionsUseAllOperators(EXPRESSIONS_CONTEXT *context);
+
+int expressionsSetOptions(EXPRESSIONS_CONTEXT *context, const char *options);
+
+/* Runs the conjecturing for at most timeBudget seconds (0 means no limit).
+ * Returns the number of conjectures or -1 in case of an error.
+ */
+int expressionsRun(EXPRESSIONS_CONTEXT *context, unsigned long timeBudget);
+
+int expressionsGetResultCount(EXPRESSIONS_CONTEXT *context);
+const char *expressionsGetResult(EXPRESSIONS_CONTEXT *context, int index);
+
+/* Returns the statistics that the program writes to stderr. */
+const char *expressionsGetMessages(EXPRESSIONS_CONTEXT *context);
+
+#endif	/* LIBEXPRESSIONS_H */
+
@@ -85,6 +85,106 @@ class Conjecture(SageObject): #Based on GraphExpression from IndependenceNumberP
                     stack.append(op(left, right))
         return stack.pop()
 
+    def compile(self, returnBoundValue=False):
+        """
+        Returns a function which evaluates this conjecture for many objects at
+        once using numpy. The function takes a dictionary which maps the name
+        of each invariant in this conjecture to an array containing the values
+        of that invariant for the objects, and returns an array containing the
+        result for each object. The attribute ``invariants`` of the function
+        is a dictionary which maps these names to the invariants. The
+        operators follow the C semantics of the program ``expressions``, e.g.,
+        for division by zero and for ``pow``, just like ``evaluate``. Missing
+        values can be given as NaN.
+
+        EXAMPLES::
+
+            >>> f = conjectures[0].compile()
+            >>> values = {name : [invariant(g) for g in objects]
+            ...           for name, invariant in f.invariants.items()}
+            >>> [g for g, holds in zip(objects, f(values)) if not holds]
+        """
+        if returnBoundValue:
+            assert self.stack[-1][0] in {operator.le, operator.lt, operator.ge, operator.gt}, "Conjecture is not a bound"
+        if getattr(self, '_compiled', None) is None:
+            self._compiled = {}
+        if returnBoundValue not in self._compiled:
+            inputList, variable, invariantsDict = self.pickling
+            self._compiled[returnBoundValue] = _compileStack(inputList, self.stack, invariantsDict,
+                                                             returnBoundValue)
+        return self._compiled[returnBoundValue]
+
+def _compileStack(inputList, operatorStack, invariantsDict, returnBoundValue):
+    """
+    Returns a function that evaluates the conjecture given by ``inputList``
+    (in the stack output format of ``expressions``) with numpy for arrays of
+    invariant values. The invariants are taken from the corresponding entries
+    of ``operatorStack``.
+    """
+    import numpy
+
+    def maximum(left, right):
+        return numpy.where(left < right, right, left)
+
+    def minimum(left, right):
+        return numpy.where(left < right, left, right)
+
+    unaryOperators = {'-1': lambda x: x - 1, '+1': lambda x: x + 1,
+                      '*2': lambda x: x * 2, '/2': lambda x: x / 2,
+                      '^2': lambda x: x * x, '-()': numpy.negative,
+                      '1/': lambda x: 1 / x, 'sqrt': numpy.sqrt, 'ln': numpy.log,
+                      'log10': numpy.log10, 'exp': numpy.exp,
+                      '10^': lambda x: numpy.power(10.0, x), 'ceil': numpy.ceil,
+                      'floor': numpy.floor, 'abs': numpy.fabs, 'sin': numpy.sin,
+                      'cos': numpy.cos, 'tan': numpy.tan, 'asin': numpy.arcsin,
+                      'acos': numpy.arccos, 'atan': numpy.arctan, 'sinh': numpy.sinh,
+                      'cosh': numpy.cosh, 'tanh': numpy.tanh, 'asinh': numpy.arcsinh,
+                      'acosh': numpy.arccosh, 'atanh': numpy.arctanh}
+    binaryOperators = {'+': numpy.add, '*': numpy.multiply, '-': numpy.subtract,
+                       '/': numpy.true_divide, '^': numpy.power,
+                       'max': maximum, 'min': minimum}
+    comparators = {'<': numpy.less, '<=': numpy.less_equal,
+                   '>': numpy.greater, '>=': numpy.greater_equal}
+
+    # the input list and the operator stack have an entry for each node
+    invariants = {}
+    steps = []
+    for op, (f, opType) in zip(inputList, operatorStack):
+        if op in invariantsDict:
+            invariants[op] = f
+            steps.append((0, op))
+        elif op in unaryOperators:
+            steps.append((1, unaryOperators[op]))
+        elif op in binaryOperators:
+            steps.append((2, binaryOperators[op]))
+        elif op in comparators:
+            steps.append((3, comparators[op]))
+        else:
+            raise ValueError("Unknown element: {}".format(op))
+
+    def evaluate(values):
+        stack = []
+        with numpy.errstate(all='ignore'):
+            for stepType, step in steps:
+                if stepType == 0:
+                    stack.append(numpy.asarray(values[step], dtype=numpy.float64))
+                elif stepType == 1:
+                    stack.append(step(stack.pop()))
+                else:
+                    right = stack.pop()
+                    left = stack.pop()
+                    if stepType == 3:
+                        left = numpy.round(left, 6)
+                        right = numpy.round(right, 6)
+                        if returnBoundValue:
+                            stack.append(right)
+                            continue
+                    stack.append(step(left, right))
+        return stack.pop()
+
+    evaluate.invariants = invariants
+    return evaluate
+
 def wrapUnboundMethod(op, invariantsDict):
     return lambda obj: getattr(obj, invariantsDict[op].__name__)()
 
@@ -188,6 +288,553 @@ def _getSpecialOperators(op):
     else:
         raise ValueError("Unknown operator: {}".format(op))
 
+class InvariantStore(object):
+    """
+    A persistent store for invariant values, kept in an SQLite database. The
+    values are stored by object key and invariant key. The key of an object is
+    given by the function ``object_key``, which should return the same string
+    for the same object in every session, e.g., a canonical label. The key of
+    an invariant is by default its module and qualified name; invariants
+    without such a name (e.g., lambda functions) are not stored unless the
+    function ``invariant_key`` gives them a key. The values are stored as
+    they are handed to ``expressions``, i.e., as floats for invariants and as
+    0 or 1 for properties, so the values of a function used as an invariant
+    and as a property are stored separately. Values that could not be
+    computed are stored as NaN, so they are not computed again.
+
+    The methods ``conjecture`` and ``propertyBasedConjecture`` look up values
+    in the store and add the values they compute to it. Several processes can
+    use the same store at the same time.
+
+    EXAMPLES::
+
+        >>> store = InvariantStore('graphs.db', lambda g: g.canonical_label().graph6_string())
+        >>> conjecture(graphs(5), [Graph.chromatic_number, Graph.order], 0, store=store)
+    """
+
+    def __init__(self, filename, object_key, invariant_key=None):
+        self.filename = filename
+        self.object_key = object_key
+        if invariant_key is None:
+            invariant_key = InvariantStore.defaultInvariantKey
+        self.invariant_key = invariant_key
+        self._connection = None
+        self._pid = None
+        self._getConnection()
+
+    @staticmethod
+    def defaultInvariantKey(invariant):
+        """
+        Returns the module and qualified name of the invariant, or ``None`` if
+        the invariant has no name that identifies it.
+        """
+        name = getattr(invariant, '__qualname__', None) or getattr(invariant, '__name__', None)
+        if name is None or '<' in name:
+            return None
+        module = getattr(invariant, '__module__', None)
+        return name if module is None else '{}.{}'.format(module, name)
+
+    def storeKey(self, invariant, kind='invariant'):
+        """
+        Returns the key under which the values of the invariant are stored
+        when it is used as the given kind (``'invariant'`` or ``'property'``),
+        or ``None`` if its values are not stored.
+        """
+        key = self.invariant_key(invariant)
+        return None if key is None else '{}:{}'.format(kind, key)
+
+    def _getConnection(self):
+        # a connection cannot be shared with a forked process
+        import os
+        if self._connection is None or self._pid != os.getpid():
+            import sqlite3
+            # the connection of the parent process should not be closed here
+            self._inheritedConnection = self._connection
+            self._connection = sqlite3.connect(self.filename, timeout=60)
+            self._pid = os.getpid()
+            # write-ahead logging allows reading while another process writes
+            self._connection.execute('PRAGMA journal_mode=WAL')
+            with self._connection:
+                self._connection.execute('CREATE TABLE IF NOT EXISTS invariant_values ('
+                                         'object_key TEXT NOT NULL, invariant_key TEXT NOT NULL, '
+                                         'value REAL, PRIMARY KEY (object_key, invariant_key))')
+        return self._connection
+
+    def lookup(self, invariantKey, objectKeys):
+        """
+        Returns a list containing for each of the object keys the stored value
+        of the invariant with the given key, or ``None`` if no value is stored.
+        """
+        connection = self._getConnection()
+        found = {}
+        objectKeys = list(objectKeys)
+        # SQLite limits the number of parameters of a query
+        for start in range(0, len(objectKeys), 500):
+            part = objectKeys[start:start + 500]
+            query = ('SELECT object_key, value FROM invariant_values WHERE invariant_key = ? '
+                     'AND object_key IN ({})'.format(','.join('?' * len(part))))
+            for key, value in connection.execute(query, [invariantKey] + part):
+                found[key] = float('nan') if value is None else value
+        return [found.get(key) for key in objectKeys]
+
+    def store(self, invariantKey, objectKeys, values):
+        """
+        Stores the values of the invariant with the given key for the objects
+        with the given keys.
+        """
+        connection = self._getConnection()
+        with connection:
+            connection.executemany('INSERT OR REPLACE INTO invariant_values VALUES (?, ?, ?)',
+                                   ((key, invariantKey, None if value != value else value)
+                                    for key, value in zip(objectKeys, values)))
+
+    def exportBinaryInvariants(self, filename, objects, invariants, mainInvariant):
+        """
+        Writes the stored values of the invariants for the objects to a file
+        in the binary invariants format of ``expressions``, which can be used
+        with the option ``--invariants``. The invariant keys are used as names
+        and missing values are written as NaN.
+        """
+        from array import array
+
+        objectKeys = [self.object_key(o) for o in objects]
+        invariantKeys = [self.invariant_key(invariant) for invariant in invariants]
+        if None in invariantKeys:
+            raise ValueError('Not all invariants have a key')
+        with open(filename, 'wb') as out:
+            out.write(_binaryInvariantsHeader(len(objects), invariantKeys, mainInvariant, None))
+            for invariant in invariants:
+                column = self.lookup(self.storeKey(invariant), objectKeys)
+                out.write(array('d', (float('nan') if value is None else value
+                                      for value in column)).tobytes())
+
+# the state of the current invariant computation, which is inherited by the
+# worker processes
+_invariantComputation = None
+
+def _computeObjectKeys(task):
+    """
+    Returns the keys of the objects with the given indices in the current
+    invariant computation, computed by the given key function.
+    """
+    keyFunction, indices = task
+    objects = _invariantComputation[0]
+    keyFunction = _invariantComputation[3][keyFunction]
+    return [keyFunction(objects[i]) for i in indices]
+
+def _computeFunctionValues(function, objects, convert):
+    """
+    Returns a list containing the converted value of the function for each of
+    the objects. If the function has a batch entry point (see ``conjecture``),
+    then it is called once for all objects, otherwise, or if that fails, the
+    function is called for each object. Values that cannot be computed are NaN.
+    """
+    results = None
+    batch = getattr(function, 'batch', None)
+    if batch is not None:
+        try:
+            results = list(batch(objects))
+            if len(results) != len(objects):
+                results = None
+        except Exception:
+            results = None
+    values = []
+    if results is not None:
+        for result in results:
+            try:
+                values.append(result if result != result else convert(result))
+            except Exception:
+                values.append(float('nan'))
+    else:
+        for o in objects:
+            try:
+                values.append(convert(function(o)))
+            except Exception:
+                values.append(float('nan'))
+    return values
+
+def _computeInvariantChunk(task):
+    """
+    Returns the values of one function for the objects with the given indices
+    in the current invariant computation. If the objects have keys for the
+    invariant store, then the values are also stored.
+    """
+    column, indices, storeKeys = task
+    objects, functions, convert, keyFunctions, store, invariantStoreKeys = _invariantComputation
+    values = _computeFunctionValues(functions[column], [objects[i] for i in indices], convert)
+    if storeKeys is not None:
+        store.store(invariantStoreKeys[column], storeKeys, values)
+    return values
+
+def _computeInvariantValues(objects, functions, convert, precomputed=None,
+                            object_key=None, invariant_key=None, workers=1,
+                            store=None, deferred=(), kind='invariant'):
+    """
+    Yields for each function in ``functions`` a list containing the converted
+    value for each object. Values that cannot be computed are NaN. Values are
+    first taken from ``precomputed`` (see ``conjecture``) and then from the
+    ``InvariantStore`` ``store``, to which the computed values are added as
+    values of the given ``kind`` (see ``InvariantStore.storeKey``). Each
+    function is computed only once for each object, also when it appears
+    several times in ``functions``, and the keys of each object are computed
+    only once. If ``workers`` is larger than 1 (or ``None`` to use all
+    processors), then the values are computed by that many worker processes
+    and each list is yielded as soon as it is complete, while the workers
+    continue with the next functions. The values of the functions at the
+    positions in ``deferred`` that are not known are not computed, but are
+    given as ``_DEFERRED_VALUE``.
+    """
+    global _invariantComputation
+    import os
+
+    if workers is None:
+        workers = os.cpu_count() or 1
+    context = None
+    if workers > 1 and len(objects) > 1:
+        import multiprocessing
+        try:
+            # the workers inherit the objects and the functions
+            context = multiprocessing.get_context('fork')
+        except ValueError:
+            pass
+
+    # only compute each distinct function once
+    unique = []
+    positions = {}
+    for function in functions:
+        if id(function) not in positions:
+            positions[id(function)] = len(unique)
+            unique.append(function)
+
+    # a function is only deferred if it is not needed elsewhere
+    deferredUnique = (set(positions[id(functions[i])] for i in deferred) -
+                      set(positions[id(function)] for i, function in enumerate(functions)
+                          if i not in deferred))
+
+    invariantStoreKeys = None
+    if store is not None:
+        invariantStoreKeys = [store.storeKey(function, kind) for function in unique]
+
+    pool = None
+    _invariantComputation = (objects, unique, convert,
+                             (object_key, store and store.object_key),
+                             store, invariantStoreKeys)
+    try:
+        if context is not None:
+            pool = context.Pool(workers)
+        chunkSize = max(1, len(objects) // (4 * workers))
+        chunks = [range(start, min(start + chunkSize, len(objects)))
+                  for start in range(0, len(objects), chunkSize)]
+
+        def computeKeys(keyFunction):
+            tasks = [(keyFunction, chunk) for chunk in chunks]
+            if pool is None:
+                return [key for task in tasks for key in _computeObjectKeys(task)]
+            return [key for part in pool.map(_computeObjectKeys, tasks) for key in part]
+
+        def lookup(column, values):
+            for i, value in enumerate(values):
+                if column[i] is None and value is not None:
+                    try:
+                        # NaN is a stored value that could not be computed
+                        column[i] = value if value != value else convert(value)
+                    except:
+                        column[i] = float('nan')
+
+        columns = [[None] * len(objects) for function in unique]
+        if precomputed:
+            keys = computeKeys(0)
+            for column, function in zip(columns, unique):
+                i_key = invariant_key(function)
+                lookup(column, [precomputed[o_key].get(i_key) if o_key in precomputed else None
+                                      for o_key in keys])
+        storeKeys = None
+        if store is not None:
+            storeKeys = computeKeys(1)
+            for column, invariantStoreKey in zip(columns, invariantStoreKeys):
+                if invariantStoreKey is not None:
+                    lookup(column, store.lookup(invariantStoreKey, storeKeys))
+
+        # the values which are not known are computed per function in chunks,
+        # except that a batch entry point gets all objects at once
+        tasks = []
+        for j, column in enumerate(columns):
+            missing = [i for i in range(len(objects)) if column[i] is None]
+            if j in deferredUnique:
+                for i in missing:
+                    column[i] = _DEFERRED_VALUE
+                continue
+            size = len(missing) if hasattr(unique[j], 'batch') else chunkSize
+            for start in range(0, len(missing), size):
+                indices = missing[start:start + size]
+                if storeKeys is None or invariantStoreKeys[j] is None:
+                    tasks.append((j, indices, None))
+                else:
+                    tasks.append((j, indices, [storeKeys[i] for i in indices]))
+        if pool is None:
+            results = map(_computeInvariantChunk, tasks)
+        else:
+            results = pool.imap(_computeInvariantChunk, tasks)
+
+        remaining = [0] * len(unique)
+        for task in tasks:
+            remaining[task[0]] += 1
+        # the results arrive in the order of the tasks
+        results = iter(results)
+        taskPosition = 0
+        for function in functions:
+            j = positions[id(function)]
+            while remaining[j]:
+                column, indices = tasks[taskPosition][:2]
+                for i, value in zip(indices, next(results)):
+                    columns[column][i] = value
+                remaining[column] -= 1
+                taskPosition += 1
+            yield columns[j]
+    finally:
+        if pool is not None:
+            pool.terminate()
+        _invariantComputation = None
+
+def _deferredValue():
+    """
+    Returns the NaN which marks a deferred value in the binary invariants
+    format of ``expressions``.
+    """
+    import struct
+    return struct.unpack('=d', struct.pack('=Q', 0x7ff800000000defe))[0]
+
+_DEFERRED_VALUE = _deferredValue()
+
+def _serveDeferredValues(requests, responses, objects, functions, convert, store=None):
+    """
+    Answers the requests of ``expressions`` for deferred invariant values
+    (see the option ``--demand-pipes``) until the file ``requests`` is closed.
+    Each request is answered by computing the values of one of the
+    ``functions`` for the requested objects. The computed values are added
+    to the ``InvariantStore`` ``store``.
+    """
+    from array import array
+
+    objectKeys = {}
+    invariantStoreKeys = {}
+    for line in requests:
+        request = [int(number) for number in line.split()]
+        function, indices = functions[request[0]], request[2:]
+        values = _computeFunctionValues(function, [objects[i] for i in indices], convert)
+        try:
+            responses.write(array('d', values).tobytes())
+            responses.flush()
+        except BrokenPipeError:
+            break
+        if store is not None:
+            if request[0] not in invariantStoreKeys:
+                invariantStoreKeys[request[0]] = store.storeKey(function)
+            if invariantStoreKeys[request[0]] is not None:
+                for i in indices:
+                    if i not in objectKeys:
+                        objectKeys[i] = store.object_key(objects[i])
+                store.store(invariantStoreKeys[request[0]], [objectKeys[i] for i in indices], values)
+
+def _binaryInvariantsHeader(objectCount, names, mainInvariant, theory, packed=False):
+    """
+    Returns the header of the binary invariants format of ``expressions``,
+    including the padding.
+    """
+    import struct
+
+    flags = 1 | (2 if theory is not None else 0) | (4 if packed else 0)
+    header = [b'\x89EXPRINV', struct.pack('=4i', objectCount, len(names), mainInvariant + 1, flags)]
+    for name in names:
+        encoded = name.encode('utf-8')
+        header.append(struct.pack('=i', len(encoded)))
+        header.append(encoded)
+    header.append(b'\0' * (-sum(len(part) for part in header) % 8))
+    return b''.join(header)
+
+def _writeBinaryInvariants(stdin, objectCount, names, mainInvariant, theory, columns):
+    """
+    Writes the invariant values to ``stdin`` in the binary invariants format
+    of ``expressions``. The argument ``theory`` is either ``None`` or a list
+    containing a value for each object, and ``columns`` yields for each
+    invariant a list containing a value for each object. Missing values are
+    given as NaN.
+    """
+    from array import array
+
+    # the operators might already have been written as text
+    stdin.flush()
+    out = stdin.buffer
+    out.write(_binaryInvariantsHeader(objectCount, names, mainInvariant, theory))
+    if theory is not None:
+        out.write(array('d', theory).tobytes())
+    for column in columns:
+        out.write(array('d', column).tobytes())
+    out.flush()
+
+def _shareBinaryInvariants(objectCount, names, mainInvariant, theory, columns, packed=False):
+    """
+    Stores the invariant values in the binary invariants format in a new POSIX
+    shared memory object, which ``expressions`` can map with the option
+    ``--invariants-shm``, and returns it as a ``SharedMemory`` instance. The
+    caller should close and unlink it. If ``packed`` is ``True``, then the
+    values are properties and are stored as packed bits. Returns ``None``
+    (without consuming ``columns``) if shared memory is not available. The
+    arguments are as for ``_writeBinaryInvariants``.
+    """
+    try:
+        import numpy
+        from multiprocessing import shared_memory
+    except ImportError:
+        return None
+
+    header = _binaryInvariantsHeader(objectCount, names, mainInvariant, theory, packed)
+    rows = len(names) + (1 if theory is not None else 0)
+    if packed:
+        # a bit vector for the defined values and one for the true values
+        rowSize = 2 * 8 * ((objectCount + 63) // 64)
+    else:
+        rowSize = 8 * objectCount
+    shared = shared_memory.SharedMemory(create=True, size=len(header) + rows * rowSize)
+    matrix = None
+    try:
+        shared.buf[:len(header)] = header
+        if packed:
+            matrix = numpy.ndarray((rows, 2, rowSize // 2), dtype=numpy.uint8,
+                                   buffer=shared.buf, offset=len(header))
+        else:
+            matrix = numpy.ndarray((rows, objectCount), dtype=numpy.float64,
+                                   buffer=shared.buf, offset=len(header))
+        def store(row, values):
+            values = numpy.fromiter(values, dtype=numpy.float64, count=objectCount)
+            if packed:
+                defined = ~numpy.isnan(values)
+                for vector, bits in enumerate((defined, defined & (values != 0))):
+                    bits = numpy.packbits(bits, bitorder='little')
+                    matrix[row, vector, :len(bits)] = bits
+                    matrix[row, vector, len(bits):] = 0
+            else:
+                matrix[row] = values
+        if theory is not None:
+            store(0, theory)
+        for row, column in enumerate(columns, rows - len(names)):
+            store(row, column)
+    except:
+        # the buffer can only be closed when no views on it remain
+        matrix = None
+        shared.close()
+        shared.unlink()
+        raise
+    matrix = None
+    return shared
+
+_library = None
+
+def _loadLibrary():
+    """
+    Returns the shared library ``libexpressions`` loaded with ``ctypes``, or
+    ``None`` if it is not available. The location of the library can be given
+    in the environment variable ``EXPRESSIONS_LIBRARY``.
+    """
+    global _library
+    if _library is None:
+        import os
+        import ctypes
+        import ctypes.util
+        _library = False
+        path = os.environ.get('EXPRESSIONS_LIBRARY') or ctypes.util.find_library('expressions')
+        if path:
+            try:
+                lib = ctypes.CDLL(path)
+            except OSError:
+                return None
+            c_int_p = ctypes.POINTER(ctypes.c_int)
+            c_double_p = ctypes.POINTER(ctypes.c_double)
+            lib.expressionsCreateContext.restype = ctypes.c_void_p
+            lib.expressionsCreateContext.argtypes = []
+            lib.expressionsFreeContext.restype = None
+            lib.expressionsFreeContext.argtypes = [ctypes.c_void_p]
+            lib.expressionsSetDataset.argtypes = [ctypes.c_void_p, ctypes.c_int,
+                ctypes.c_int, ctypes.c_int, c_double_p, c_double_p,
+                ctypes.POINTER(ctypes.c_char_p)]
+            lib.expressionsSetOperators.argtypes = [ctypes.c_void_p,
+                c_int_p, ctypes.c_int, c_int_p, ctypes.c_int, c_int_p, ctypes.c_int]
+            lib.expressionsSetOptions.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+            lib.expressionsRun.argtypes = [ctypes.c_void_p, ctypes.c_ulong]
+            lib.expressionsGetResultCount.argtypes = [ctypes.c_void_p]
+            lib.expressionsGetResult.restype = ctypes.c_char_p
+            lib.expressionsGetResult.argtypes = [ctypes.c_void_p, ctypes.c_int]
+            lib.expressionsGetMessages.restype = ctypes.c_char_p
+            lib.expressionsGetMessages.argtypes = [ctypes.c_void_p]
+            _library = lib
+    return _library or None
+
+def _requireLibrary():
+    """
+    Returns the shared library ``libexpressions``, or raises an error if it is
+    not available.
+    """
+    library = _loadLibrary()
+    if library is None:
+        raise RuntimeError('The library libexpressions could not be loaded')
+    return library
+
+def _runLibrary(lib, options, time, operators, objectCount, names, mainInvariant, theory, columns):
+    """
+    Runs the conjecturing in this process using the shared library and returns
+    a tuple containing the list of conjectures in the stack format (each as a
+    list of lines) and the messages of the program. The operators are given as
+    a list of strings such as ``'U 0'``, or ``None`` to use all operators. The
+    arguments ``theory`` and ``columns`` are as for ``_writeBinaryInvariants``.
+    """
+    import ctypes
+    from array import array
+
+    # the values are handed to the library without copying them
+    values = array('d')
+    for column in columns:
+        values.extend(column)
+    if len(values) != objectCount * len(names):
+        raise ValueError('Expected {} invariant values, got {}'.format(
+                                        objectCount * len(names), len(values)))
+    c_values = (ctypes.c_double * len(values)).from_buffer(values)
+    c_theory = None
+    if theory is not None:
+        theory = array('d', theory)
+        c_theory = (ctypes.c_double * len(theory)).from_buffer(theory)
+    c_names = (ctypes.c_char_p * len(names))(*[name.encode('utf-8') for name in names])
+
+    context = lib.expressionsCreateContext()
+    if not context:
+        raise MemoryError('Could not create a context for expressions')
+    try:
+        if lib.expressionsSetDataset(context, objectCount, len(names), mainInvariant,
+                                     c_values, c_theory, c_names):
+            raise ValueError('The dataset was rejected by expressions')
+        if operators is not None:
+            numbers = {'U' : [], 'C' : [], 'N' : []}
+            for op in operators:
+                kind, number = op.split()
+                numbers[kind].append(int(number))
+            arrays = [(ctypes.c_int * len(numbers[kind]))(*numbers[kind]) for kind in 'UCN']
+            if lib.expressionsSetOperators(context, arrays[0], len(numbers['U']),
+                                           arrays[1], len(numbers['C']),
+                                           arrays[2], len(numbers['N'])):
+                raise ValueError('The operators were rejected by expressions')
+        if lib.expressionsSetOptions(context, options.encode('utf-8')):
+            raise ValueError('The options were rejected by expressions')
+        count = lib.expressionsRun(context, time)
+        messages = (lib.expressionsGetMessages(context) or b'').decode('utf-8')
+        if count < 0:
+            raise RuntimeError('expressions failed:\n' + messages)
+        results = []
+        for i in range(count):
+            result = lib.expressionsGetResult(context, i).decode('utf-8')
+            results.append([l.strip() for l in result.split('\n') if l.strip()])
+        return results, messages
+    finally:
+        lib.expressionsFreeContext(context)
+
 def allOperators():
     """
     Returns a set containing all the operators that can be used with the
@@ -209,7 +856,8 @@ def allOperators():
 
 def conjecture(objects, invariants, mainInvariant, variableName='x', time=5,
                debug=False, verbose=False, upperBound=True, operators=None,
-               theory=None, precomputed=None):
+               theory=None, precomputed=None, workers=1, store=None,
+               library=False):
     """
     Runs the conjecturing program for invariants with the provided objects,
     invariants and main invariant. This method requires the package conjecturing
@@ -220,7 +868,18 @@ def conjecture(objects, invariants, mainInvariant, variableName='x', time=5,
     -  ``objects`` - a list of objects about which conjectures should be made.
     -  ``invariants`` - a list of functions (callable objects) which take a
        single argument and return a numerical real value. Each function should
-       be able to produce a value for each of the elements of objects.
+       be able to produce a value for each of the elements of objects. A
+       function can also have an attribute ``batch``: a function which takes a
+       list of objects and returns a list containing the value for each of
+       them (or NaN if it is unknown). This batch entry point is then used
+       instead, e.g., to use a single sieve for all objects. If it raises an
+       exception, then the values are computed one object at a time. A
+       function can also have an attribute ``cost``: a number that gives how
+       expensive the function is compared to the other functions (which have
+       cost 0). The values of such a function are not computed in advance,
+       but only when the program ``expressions`` needs them, and expressions
+       with cheap invariants are tried first. This does not apply to the main
+       invariant.
     -  ``mainInvariant`` - an integer that is the index of one of the elements
        of invariants. All conjectures will then be a bound for the invariant that
        corresponds to this index.
@@ -250,6 +909,25 @@ def conjecture(objects, invariants, mainInvariant, variableName='x', time=5,
        ``precomputed`` is not a tuple, it is assumed to be a dictionary, and the
        same procedure as above is used, but the identity is used for both key
        functions.
+    -  ``workers`` - if given, this integer specifies the number of processes
+       that compute the invariant values. If this is ``None``, then a process
+       is used for each processor. The values of an invariant are handed to
+       the program ``expressions`` as soon as they are known for all objects,
+       while the next invariants are still being computed. The key of each
+       object is computed only once. The default value is 1, i.e., all values
+       are computed in this process.
+    -  ``store`` - if given, specifies an ``InvariantStore`` in which invariant
+       values are looked up before they are computed (but after the values in
+       ``precomputed``). The computed values are added to the store, so they
+       will not have to be computed again in a later session. The default
+       value is ``None``.
+    -  ``library`` - if given, this boolean value specifies whether the
+       conjecturing is done in this process by the shared library
+       ``libexpressions`` instead of by the program ``expressions``. The
+       location of the library can be given in the environment variable
+       ``EXPRESSIONS_LIBRARY``. The library is not used when invariant values
+       are computed on demand (see ``cost`` above). The default value is
+       ``False``.
     -  ``operators`` - if given, specifies a set of operators that can be used.
        If this is ``None``, then all known operators are used. Otherwise only
        the specified operators are used. It is advised to use the method
@@ -355,6 +1033,7 @@ def conjecture(objects, invariants, mainInvariant, variableName='x', time=5,
     if not theory: theory=None
     if not precomputed:
         precomputed = None
+        object_key = invariant_key = None
     elif type(precomputed) == tuple:
         assert len(precomputed) == 3, 'The length of the precomputed tuple should be 3.'
         precomputed, object_key, invariant_key = precomputed
@@ -399,91 +1078,145 @@ def conjecture(objects, invariants, mainInvariant, variableName='x', time=5,
                              '--all-operators ' if operators is None else '',
                              time, '--leq' if upperBound else '--geq')
 
-    if verbose:
-        print('Using the following command')
-        print(command)
-
-    import subprocess
-    sp = subprocess.Popen(command, shell=True,
-                          stdin=subprocess.PIPE, stdout=subprocess.PIPE,
-                          stderr=subprocess.PIPE, close_fds=True,
-                          encoding='utf-8')
-    stdin = sp.stdin
+    invariantFunctions = [invariantsDict[name] for name in names]
+    costs = [getattr(function, 'cost', None) for function in invariantFunctions]
+    demand = any(cost is not None for j, cost in enumerate(costs) if j != mainInvariant)
 
-    if operators is not None:
-        stdin.write('{}\n'.format(len(operators)))
-        for op in operators:
-            stdin.write('{}\n'.format(operatorDict[op]))
+    # the library cannot request deferred values
+    library = _requireLibrary() if library and not demand else None
 
-    stdin.write('{} {} {}\n'.format(len(objects), len(invariants), mainInvariant + 1))
-
-    for invariant in names:
-        stdin.write('{}\n'.format(invariant))
-
-    def get_value(invariant, o):
-        precomputed_value = None
-        if precomputed:
-            o_key = object_key(o)
-            i_key = invariant_key(invariant)
-            if o_key in precomputed:
-                if i_key in precomputed[o_key]:
-                    precomputed_value = precomputed[o_key][i_key]
-        if precomputed_value is None:
-            return invariant(o)
-        else:
-            return precomputed_value
+    if verbose and library is not None:
+        print('Using the library {}'.format(library._name))
 
+    functions = invariantFunctions
+    offset = 0
+    if theory is not None:
+        functions = list(theory) + functions
+        offset = len(theory)
+    deferred = [offset + j for j, cost in enumerate(costs)
+                if cost is not None and j != mainInvariant]
+    columns = _computeInvariantValues(objects, functions, float, precomputed,
+                                      object_key, invariant_key, workers, store,
+                                      deferred)
+
+    theoryValues = None
     if theory is not None:
         if verbose:
-            print("Started writing theory to expressions")
-        for o in objects:
-            if upperBound:
-                try:
-                    stdin.write('{}\n'.format(min(float(get_value(t, o)) for t in theory)))
-                except:
-                    stdin.write('NaN\n')
+            print("Started computing theory")
+        theoryColumns = [next(columns) for t in theory]
+        theoryValues = []
+        for values in zip(*theoryColumns):
+            if any(value != value for value in values):
+                theoryValues.append(float('nan'))
+            elif upperBound:
+                theoryValues.append(min(values))
             else:
-                try:
-                    stdin.write('{}\n'.format(max(float(get_value(t, o)) for t in theory)))
-                except:
-                    stdin.write('NaN\n')
+                theoryValues.append(max(values))
         if verbose:
-            print("Finished writing theory to expressions")
-
-    if verbose:
-        print("Started computing and writing invariant values to expressions")
-
-    for o in objects:
-        for invariant in names:
-            try:
-                stdin.write('{}\n'.format(float(get_value(invariantsDict[invariant], o))))
-            except:
-                stdin.write('NaN\n')
+            print("Finished computing theory")
 
-    stdin.flush()
-
-    if verbose:
-        print("Finished computing and writing invariant values to expressions")
+    if library is not None:
+        if verbose:
+            print("Started computing invariant values and conjecturing")
+        options = '{}{}--dalmatian {} --allowed-skips 0'.format(
+                        '-v ' if verbose and debug else '', '-t ' if theory is not None else '',
+                        '--leq' if upperBound else '--geq')
+        stacks, messages = _runLibrary(library, options, time,
+                                       None if operators is None else [operatorDict[op] for op in operators],
+                                       len(objects), names, mainInvariant, theoryValues,
+                                       columns)
+        if debug:
+            for l in messages.splitlines():
+                print('> ' + l.rstrip())
+    else:
+        shared = _shareBinaryInvariants(len(objects), names, mainInvariant, theoryValues,
+                                        columns)
+
+        if shared is not None:
+            if verbose:
+                print("Finished computing invariant values and sharing them with expressions")
+            command += ' --invariants-shm /{}'.format(shared.name)
+
+        demandFiles = ()
+        if demand:
+            import os
+            requests, requestsOut = os.pipe()
+            responsesIn, responses = os.pipe()
+            demandFiles = (requestsOut, responsesIn)
+            command += ' --invariant-costs {} --demand-pipes /dev/fd/{},/dev/fd/{}'.format(
+                            ','.join(str(float(cost or 0)) for cost in costs),
+                            requestsOut, responsesIn)
 
-    if debug:
-        for l in sp.stderr:
-            print('> ' + l.rstrip())
+        if verbose:
+            print('Using the following command')
+            print(command)
+
+        import subprocess
+        sp = subprocess.Popen(command, shell=True,
+                              stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                              stderr=subprocess.PIPE, close_fds=True,
+                              pass_fds=demandFiles, encoding='utf-8')
+        stdin = sp.stdin
+
+        messages = sp.stderr
+        if demand:
+            import threading
+            os.close(requestsOut)
+            os.close(responsesIn)
+            # the messages are collected while the requests are answered
+            messages = []
+            reader = threading.Thread(target=lambda: messages.extend(sp.stderr))
+            reader.start()
+
+        try:
+            if operators is not None:
+                stdin.write('{}\n'.format(len(operators)))
+                for op in operators:
+                    stdin.write('{}\n'.format(operatorDict[op]))
+
+            if shared is None:
+                if verbose:
+                    print("Started computing and writing invariant values to expressions")
+
+                _writeBinaryInvariants(stdin, len(objects), names, mainInvariant, theoryValues,
+                                       columns)
+
+                if verbose:
+                    print("Finished computing and writing invariant values to expressions")
+
+            stdin.close()
+
+            if demand:
+                if verbose:
+                    print("Started answering requests for deferred invariant values")
+                with os.fdopen(requests) as requestsFile, os.fdopen(responses, 'wb') as responsesFile:
+                    _serveDeferredValues(requestsFile, responsesFile, objects,
+                                         invariantFunctions, float, store)
+                reader.join()
+
+            if debug:
+                for l in messages:
+                    print('> ' + l.rstrip())
+
+            # process the output
+            stacks = []
+            inputList = []
 
-    # process the output
-    out = sp.stdout
+            for l in sp.stdout:
+                op = l.strip()
+                if op:
+                    inputList.append(op)
+                else:
+                    stacks.append(inputList)
+                    inputList = []
+        finally:
+            if shared is not None:
+                shared.close()
+                shared.unlink()
 
     variable = SR.var(variableName)
 
-    conjectures = []
-    inputList = []
-
-    for l in out:
-        op = l.strip()
-        if op:
-            inputList.append(op)
-        else:
-            conjectures.append(_makeConjecture(inputList, variable, invariantsDict))
-            inputList = []
+    conjectures = [_makeConjecture(stack, variable, invariantsDict) for stack in stacks]
 
     if verbose:
         print("Finished conjecturing")
@@ -571,7 +1304,8 @@ def allPropertyBasedOperators():
 
 def propertyBasedConjecture(objects, properties, mainProperty, time=5, debug=False,
                             verbose=False, sufficient=True, operators=None,
-                            theory=None, precomputed=None):
+                            theory=None, precomputed=None, workers=1, store=None,
+                            library=False):
     """
     Runs the conjecturing program for properties with the provided objects,
     properties and main property. This method requires the package conjecturing
@@ -582,7 +1316,8 @@ def propertyBasedConjecture(objects, properties, mainProperty, time=5, debug=Fal
     -  ``objects`` - a list of objects about which conjectures should be made.
     -  ``properties`` - a list of functions (callable objects) which take a
        single argument and return a boolean value. Each function should
-       be able to produce a value for each of the elements of objects.
+       be able to produce a value for each of the elements of objects. As for
+       ``conjecture``, a function can have a batch entry point ``batch``.
     -  ``mainProperty`` - an integer that is the index of one of the elements
        of properties. All conjectures will then be a bound for the property that
        corresponds to this index.
@@ -603,6 +1338,23 @@ def propertyBasedConjecture(objects, properties, mainProperty, time=5, debug=Fal
        ``allPropertyBasedOperators()`` to get a set containing all operators and
        then removing the operators which are not needed. The default value is
        ``None``.
+    -  ``workers`` - if given, this integer specifies the number of processes
+       that compute the property values. If this is ``None``, then a process
+       is used for each processor. The values of a property are handed to
+       the program ``expressions`` as soon as they are known for all objects,
+       while the next properties are still being computed. The key of each
+       object is computed only once. The default value is 1, i.e., all values
+       are computed in this process.
+    -  ``store`` - if given, specifies an ``InvariantStore`` in which property
+       values are looked up before they are computed (but after the values in
+       ``precomputed``). The computed values are added to the store, so they
+       will not have to be computed again in a later session. The default
+       value is ``None``.
+    -  ``library`` - if given, this boolean value specifies whether the
+       conjecturing is done in this process by the shared library
+       ``libexpressions`` instead of by the program ``expressions``. The
+       location of the library can be given in the environment variable
+       ``EXPRESSIONS_LIBRARY``. The default value is ``False``.
     -  ``debug`` - if given, this boolean value specifies whether the output of
        the program ``expressions`` to ``stderr`` is printed. The default value
        is ``False``.
@@ -666,6 +1418,7 @@ def propertyBasedConjecture(objects, properties, mainProperty, time=5, debug=Fal
     if not theory: theory=None
     if not precomputed:
         precomputed = None
+        object_key = invariant_key = None
     elif type(precomputed) == tuple:
         assert len(precomputed) == 3, 'The length of the precomputed tuple should be 3.'
         precomputed, object_key, invariant_key = precomputed
@@ -700,90 +1453,110 @@ def propertyBasedConjecture(objects, properties, mainProperty, time=5, debug=Fal
                              '--all-operators ' if operators is None else '',
                              time, '--sufficient' if sufficient else '--necessary')
 
-    if verbose:
-        print('Using the following command')
-        print(command)
-
-    import subprocess
-    sp = subprocess.Popen(command, shell=True,
-                          stdin=subprocess.PIPE, stdout=subprocess.PIPE,
-                          stderr=subprocess.PIPE, close_fds=True,
-                          encoding='utf-8')
-    stdin = sp.stdin
-
-    if operators is not None:
-        stdin.write('{}\n'.format(len(operators)))
-        for op in operators:
-            stdin.write('{}\n'.format(operatorDict[op]))
+    library = _requireLibrary() if library else None
 
-    stdin.write('{} {} {}\n'.format(len(objects), len(properties), mainProperty + 1))
+    if verbose and library is not None:
+        print('Using the library {}'.format(library._name))
 
-    for property in names:
-        stdin.write('{}\n'.format(property))
+    def property_value(value):
+        return 1 if bool(value) else 0
 
-    def get_value(prop, o):
-        precomputed_value = None
-        if precomputed:
-            o_key = object_key(o)
-            p_key = invariant_key(prop)
-            if o_key in precomputed:
-                if p_key in precomputed[o_key]:
-                    precomputed_value = precomputed[o_key][p_key]
-        if precomputed_value is None:
-            return prop(o)
-        else:
-            return precomputed_value
+    functions = [propertiesDict[name] for name in names]
+    if theory is not None:
+        functions = list(theory) + functions
+    columns = _computeInvariantValues(objects, functions, property_value, precomputed,
+                                      object_key, invariant_key, workers, store,
+                                      kind='property')
 
+    theoryValues = None
     if theory is not None:
         if verbose:
-            print("Started writing theory to expressions")
-        for o in objects:
-            if sufficient:
-                try:
-                    stdin.write('{}\n'.format(max((1 if bool(get_value(t, o)) else 0) for t in theory)))
-                except:
-                    stdin.write('-1\n')
+            print("Started computing theory")
+        theoryColumns = [next(columns) for t in theory]
+        theoryValues = []
+        for values in zip(*theoryColumns):
+            if any(value != value for value in values):
+                theoryValues.append(float('nan'))
+            elif sufficient:
+                theoryValues.append(max(values))
             else:
-                try:
-                    stdin.write('{}\n'.format(min((1 if bool(get_value(t, o)) else 0) for t in theory)))
-                except:
-                    stdin.write('-1\n')
+                theoryValues.append(min(values))
         if verbose:
-            print("Finished writing theory to expressions")
+            print("Finished computing theory")
 
-    if verbose:
-        print("Started computing and writing property values to expressions")
+    if library is not None:
+        if verbose:
+            print("Started computing property values and conjecturing")
+        options = '-p {}{}--dalmatian {} --allowed-skips 0'.format(
+                        '-v ' if verbose and debug else '', '-t ' if theory is not None else '',
+                        '--sufficient' if sufficient else '--necessary')
+        stacks, messages = _runLibrary(library, options, time,
+                                       None if operators is None else [operatorDict[op] for op in operators],
+                                       len(objects), names, mainProperty, theoryValues,
+                                       columns)
+        if debug:
+            for l in messages.splitlines():
+                print('> ' + l.rstrip())
+    else:
+        shared = _shareBinaryInvariants(len(objects), names, mainProperty, theoryValues,
+                                        columns, packed=True)
 
-    for o in objects:
-        for property in names:
-            try:
-                stdin.write('{}\n'.format(1 if bool(get_value(propertiesDict[property], o)) else 0))
-            except:
-                stdin.write('-1\n')
+        if shared is not None:
+            if verbose:
+                print("Finished computing property values and sharing them with expressions")
+            command += ' --invariants-shm /{}'.format(shared.name)
 
-    stdin.flush()
+        if verbose:
+            print('Using the following command')
+            print(command)
 
-    if verbose:
-        print("Finished computing and writing property values to expressions")
+        import subprocess
+        sp = subprocess.Popen(command, shell=True,
+                              stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                              stderr=subprocess.PIPE, close_fds=True,
+                              encoding='utf-8')
+        stdin = sp.stdin
 
-    if debug:
-        for l in sp.stderr:
-            print('> ' + l.rstrip())
+        try:
+            if operators is not None:
+                stdin.write('{}\n'.format(len(operators)))
+                for op in operators:
+                    stdin.write('{}\n'.format(operatorDict[op]))
 
-    # process the output
-    out = sp.stdout
+            if shared is None:
+                if verbose:
+                    print("Started computing and writing property values to expressions")
 
-    conjectures = []
-    inputList = []
+                _writeBinaryInvariants(stdin, len(objects), names, mainProperty, theoryValues,
+                                       columns)
 
-    for l in out:
-        op = l.strip()
-        if op:
-            inputList.append(op)
-        else:
-            conjectures.append(_makePropertyBasedConjecture(inputList, propertiesDict))
+                if verbose:
+                    print("Finished computing and writing property values to expressions")
+
+            stdin.close()
+
+            if debug:
+                for l in sp.stderr:
+                    print('> ' + l.rstrip())
+
+            # process the output
+            stacks = []
             inputList = []
 
+            for l in sp.stdout:
+                op = l.strip()
+                if op:
+                    inputList.append(op)
+                else:
+                    stacks.append(inputList)
+                    inputList = []
+        finally:
+            if shared is not None:
+                shared.close()
+                shared.unlink()
+
+    conjectures = [_makePropertyBasedConjecture(stack, propertiesDict) for stack in stacks]
+
     if verbose:
         print("Finished conjecturing")
 
@@ -1,3 +1,5 @@
+import numpy
+
 
 def determinant(m):
     return m.determinant()
@@ -45,6 +47,27 @@ def l_inf_norm(m):
 def max_column_sum(m):
     return max(sum(c) for c in m.columns())
 
+def _integer_matrices_batch(function):
+    #applies a numpy function to a stack of integer matrices of the same size
+    def batch(matrices):
+        if any(m.base_ring() is not ZZ for m in matrices):
+            raise ValueError("The batch form only handles integer matrices")
+        values = [None]*len(matrices)
+        sizes = {}
+        for i, m in enumerate(matrices):
+            sizes.setdefault(m.dimensions(), []).append(i)
+        for indices in sizes.values():
+            stack = numpy.array([matrices[i].numpy(dtype=float) for i in indices])
+            for i, value in zip(indices, function(stack)):
+                values[i] = float(value)
+        return values
+    return batch
+
+frobenius_norm.batch = _integer_matrices_batch(lambda s: numpy.sqrt((s*s).sum(axis=(1,2))))
+l2_norm.batch = _integer_matrices_batch(lambda s: numpy.sqrt(numpy.abs(s).sum(axis=(1,2))))
+l_inf_norm.batch = _integer_matrices_batch(lambda s: numpy.abs(s).max(axis=(1,2)))
+max_column_sum.batch = _integer_matrices_batch(lambda s: s.sum(axis=1).max(axis=1))
+
 def ratio_min_max_absolute_eigenvalues(m):
     aevs = [abs(ev) for ev in m.eigenvalues()]
     Maevs = max(aevs)
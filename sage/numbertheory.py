@@ -26,6 +26,17 @@ def goldbach(x):
             count+=1
     return count
 
+def prime_count(n):
+    return prime_pi(n)
+
+def _prime_count_batch(numbers):
+    #a single sieve for all numbers
+    from bisect import bisect_right
+    primes = prime_range(2, max(numbers)+1)
+    return [bisect_right(primes, n) for n in numbers]
+
+prime_count.batch = _prime_count_batch
+
 def mertens(x):
     #see [Crandall - Pomerance, 2005], p.36
 
@@ -44,9 +55,39 @@ def mertens(x):
         n += 1
     return m
 
+def _mertens_batch(numbers):
+    #sieve the Moebius function up to the largest number and sum it once
+    limit = max(floor(x) for x in numbers)
+    mu = [1]*(limit+1)
+    for p in prime_range(2, limit+1):
+        for k in range(p, limit+1, p):
+            mu[k] = -mu[k]
+        for k in range(p*p, limit+1, p*p):
+            mu[k] = 0
+    partial = [0]*(limit+1)
+    for n in range(1, limit+1):
+        partial[n] = partial[n-1] + mu[n]
+    return [partial[floor(x)] if x >= 1 else 0 for x in numbers]
+
+mertens.batch = _mertens_batch
+
 def reciprocal_prime_sum(x):
     return sum(1/p for p in prime_range(2, x+1))
 
+def _prime_prefix_batch(numbers, start, combine):
+    #combines the primes up to each number, going through the primes only once
+    primes = prime_range(2, max(numbers)+1)
+    values = {}
+    value, i = start, 0
+    for x in sorted(set(numbers)):
+        while i < len(primes) and primes[i] <= x:
+            value = combine(value, primes[i])
+            i += 1
+        values[x] = value
+    return [values[x] for x in numbers]
+
+reciprocal_prime_sum.batch = lambda numbers: _prime_prefix_batch(numbers, 0, lambda s, p: s + 1/p)
+
 def max_prime_divisor(x):
     return max(p for p,_ in factor(x))
 
@@ -56,8 +97,10 @@ def prime_product(x):
         prod *= p
     return prod
 
+prime_product.batch = lambda numbers: _prime_prefix_batch(numbers, 1, lambda s, p: s * p)
+
 invariants = [goldbach, 
-              ('prime_pi',prime_pi),
+              ('prime_pi',prime_count),
               ('euler_phi', euler_phi),
               number,
               digits10,